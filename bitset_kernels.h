@@ -0,0 +1,175 @@
+#ifndef BITSET_KERNELS_H
+#define BITSET_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITSET_KERNELS_X86 1
+#endif
+
+// Word-array kernels for dense bitmaps: out = a OP b, returning the popcount
+// of out so callers learn the result cardinality in the same pass. The best
+// implementation for the running CPU (AVX-512 with VPOPCNTDQ, AVX2, or
+// portable scalar) is picked once, on first use, so the binary itself needs
+// no -m flags.
+namespace kernels {
+
+using BinaryOp = uint64_t (*)(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words);
+using CountOp = uint64_t (*)(const uint64_t* a, size_t words);
+
+struct Ops {
+    BinaryOp andWords;
+    BinaryOp orWords;
+    BinaryOp andNotWords;
+    CountOp popcount;
+    const char* name;
+};
+
+namespace scalar {
+
+template <typename Combine>
+inline uint64_t apply(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words, Combine combine) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < words; ++i) {
+        out[i] = combine(a[i], b[i]);
+        count += static_cast<uint64_t>(__builtin_popcountll(out[i]));
+    }
+    return count;
+}
+
+inline uint64_t andWords(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words) {
+    return apply(a, b, out, words, [](uint64_t x, uint64_t y) { return x & y; });
+}
+inline uint64_t orWords(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words) {
+    return apply(a, b, out, words, [](uint64_t x, uint64_t y) { return x | y; });
+}
+inline uint64_t andNotWords(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words) {
+    return apply(a, b, out, words, [](uint64_t x, uint64_t y) { return x & ~y; });
+}
+inline uint64_t popcount(const uint64_t* a, size_t words) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < words; ++i) {
+        count += static_cast<uint64_t>(__builtin_popcountll(a[i]));
+    }
+    return count;
+}
+
+} // namespace scalar
+
+#ifdef BITSET_KERNELS_X86
+
+namespace avx2 {
+
+// Nibble-lookup popcount (Mula): per-byte counts via pshufb, summed with sad.
+__attribute__((target("avx2"))) inline __m256i popcount256(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_and_si256(v, low);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) inline uint64_t horizontal(__m256i acc) {
+    return static_cast<uint64_t>(_mm256_extract_epi64(acc, 0)) + static_cast<uint64_t>(_mm256_extract_epi64(acc, 1)) +
+           static_cast<uint64_t>(_mm256_extract_epi64(acc, 2)) + static_cast<uint64_t>(_mm256_extract_epi64(acc, 3));
+}
+
+#define BITSET_AVX2_BINARY(NAME, EXPR, SCALAR)                                                          \
+    __attribute__((target("avx2"))) inline uint64_t NAME(const uint64_t* a, const uint64_t* b,           \
+                                                         uint64_t* out, size_t words) {                  \
+        __m256i acc = _mm256_setzero_si256();                                                             \
+        size_t i = 0;                                                                                     \
+        for (; i + 4 <= words; i += 4) {                                                                  \
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));                      \
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));                      \
+            __m256i r = EXPR;                                                                             \
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);                                  \
+            acc = _mm256_add_epi64(acc, popcount256(r));                                                  \
+        }                                                                                                 \
+        return horizontal(acc) + SCALAR(a + i, b + i, out + i, words - i);                               \
+    }
+
+BITSET_AVX2_BINARY(andWords, _mm256_and_si256(x, y), scalar::andWords)
+BITSET_AVX2_BINARY(orWords, _mm256_or_si256(x, y), scalar::orWords)
+BITSET_AVX2_BINARY(andNotWords, _mm256_andnot_si256(y, x), scalar::andNotWords)
+#undef BITSET_AVX2_BINARY
+
+__attribute__((target("avx2"))) inline uint64_t popcount(const uint64_t* a, size_t words) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        acc = _mm256_add_epi64(acc, popcount256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i))));
+    }
+    return horizontal(acc) + scalar::popcount(a + i, words - i);
+}
+
+} // namespace avx2
+
+namespace avx512 {
+
+// Spelled out rather than _mm512_reduce_add_epi64 / _mm512_andnot_si512,
+// whose GCC 12 implementations trip -Wuninitialized.
+__attribute__((target("avx512f"))) inline uint64_t horizontal(__m512i acc) {
+    alignas(64) uint64_t lanes[8];
+    _mm512_store_si512(lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+#define BITSET_AVX512_BINARY(NAME, EXPR, SCALAR)                                                        \
+    __attribute__((target("avx512f,avx512vpopcntdq"))) inline uint64_t NAME(                           \
+        const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words) {                             \
+        __m512i acc = _mm512_setzero_si512();                                                             \
+        size_t i = 0;                                                                                     \
+        for (; i + 8 <= words; i += 8) {                                                                  \
+            __m512i x = _mm512_loadu_si512(a + i);                                                        \
+            __m512i y = _mm512_loadu_si512(b + i);                                                        \
+            __m512i r = EXPR;                                                                             \
+            _mm512_storeu_si512(out + i, r);                                                              \
+            acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(r));                                          \
+        }                                                                                                 \
+        return horizontal(acc) + SCALAR(a + i, b + i, out + i, words - i);                               \
+    }
+
+BITSET_AVX512_BINARY(andWords, _mm512_and_si512(x, y), scalar::andWords)
+BITSET_AVX512_BINARY(orWords, _mm512_or_si512(x, y), scalar::orWords)
+BITSET_AVX512_BINARY(andNotWords, _mm512_ternarylogic_epi64(x, y, y, 0x30) /* x & ~y */, scalar::andNotWords)
+#undef BITSET_AVX512_BINARY
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline uint64_t popcount(const uint64_t* a, size_t words) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= words; i += 8) {
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(a + i)));
+    }
+    return horizontal(acc) + scalar::popcount(a + i, words - i);
+}
+
+} // namespace avx512
+
+#endif // BITSET_KERNELS_X86
+
+inline Ops selectOps() {
+#ifdef BITSET_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+        return {avx512::andWords, avx512::orWords, avx512::andNotWords, avx512::popcount, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return {avx2::andWords, avx2::orWords, avx2::andNotWords, avx2::popcount, "avx2"};
+    }
+#endif
+    return {scalar::andWords, scalar::orWords, scalar::andNotWords, scalar::popcount, "scalar"};
+}
+
+inline const Ops& ops() {
+    static const Ops selected = selectOps();
+    return selected;
+}
+
+} // namespace kernels
+
+#endif // BITSET_KERNELS_H
@@ -0,0 +1,63 @@
+#ifndef CHARACTERISTIC_DICTIONARY_H
+#define CHARACTERISTIC_DICTIONARY_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Interns characteristic strings to dense uint32 IDs in first-seen order.
+// Strings are hashed once, when they are loaded or when a query is resolved;
+// everything downstream compares integers.
+class CharacteristicDictionary {
+public:
+    static constexpr uint32_t kMissing = UINT32_MAX;
+
+    uint32_t intern(std::string_view name) {
+        auto it = index.find(name);
+        if (it != index.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(storage.size());
+        storage.emplace_back(name);
+        index.emplace(storage.back(), id);
+        return id;
+    }
+
+    uint32_t find(std::string_view name) const {
+        auto it = index.find(name);
+        return it == index.end() ? kMissing : it->second;
+    }
+
+    const std::string& name(uint32_t id) const { return storage[id]; }
+
+    size_t size() const { return storage.size(); }
+
+    void clear() {
+        index.clear();
+        storage.clear();
+    }
+
+    CharacteristicDictionary() = default;
+    CharacteristicDictionary(const CharacteristicDictionary& other) { *this = other; }
+    CharacteristicDictionary& operator=(const CharacteristicDictionary& other) {
+        if (this != &other) {
+            clear();
+            for (const std::string& name : other.storage) {
+                intern(name);
+            }
+        }
+        return *this;
+    }
+    // Moving a deque hands over its blocks, so the index views stay valid.
+    CharacteristicDictionary(CharacteristicDictionary&&) = default;
+    CharacteristicDictionary& operator=(CharacteristicDictionary&&) = default;
+
+private:
+    // The index keys are views into `storage`, whose elements never move.
+    std::deque<std::string> storage;
+    std::unordered_map<std::string_view, uint32_t> index;
+};
+
+#endif // CHARACTERISTIC_DICTIONARY_H
@@ -0,0 +1,368 @@
+#ifndef COMMUNITY_H
+#define COMMUNITY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "counter_rng.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Community detection by Louvain modularity optimization (Blondel et al.,
+// 2008): vertices move to the neighboring community with the best modularity
+// gain until no move helps, then each community becomes one vertex of the
+// next level's weighted graph, until a level merges nothing.
+namespace community {
+
+struct Options {
+    double resolution = 1.0; // above 1 favours smaller communities
+    size_t maxLevels = 16;
+    size_t maxPasses = 32;   // local-moving passes per level
+    double minGain = 1e-6;   // a level stops once a pass gains less modularity
+    uint64_t seed = 1;       // shuffles the vertex subsets moved together
+};
+
+struct Result {
+    std::vector<uint32_t> community; // per dense vertex; 0 is the largest
+    std::vector<size_t> sizes;       // per community, non-increasing
+    std::vector<double> modularity;  // after each level
+};
+
+namespace detail {
+
+// One level's adjacency: rows as in CsrGraph, each entry weighing 1 when
+// there are no weights (level 0). A self-loop entry holds the weight inside
+// the vertex, counted from both ends.
+struct View {
+    size_t n;
+    const uint64_t* offsets;
+    const uint32_t* targets;
+    const double* weights;
+
+    double weight(uint64_t e) const { return weights ? weights[e] : 1.0; }
+};
+
+struct Level {
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<double> weights;
+
+    View view() const { return View{offsets.size() - 1, offsets.data(), targets.data(), weights.data()}; }
+};
+
+// Q = in / 2m - resolution * sum over communities of (tot / 2m)^2, where in
+// sums row weights whose endpoints share a community.
+inline double modularity(const View& graph, const std::vector<uint32_t>& membership, const std::vector<double>& tot,
+                         double twoM, double resolution) {
+    std::vector<double> partial(parallel::blockCount(graph.n), 0);
+    parallel::forBlocks(graph.n, [&](size_t begin, size_t end, unsigned worker) {
+        double inside = 0;
+        for (size_t v = begin; v < end; ++v) {
+            for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                if (membership[graph.targets[e]] == membership[v]) {
+                    inside += graph.weight(e);
+                }
+            }
+        }
+        partial[worker] = inside;
+    });
+    double inside = 0, spread = 0;
+    for (double p : partial) {
+        inside += p;
+    }
+    for (double t : tot) {
+        spread += (t / twoM) * (t / twoM);
+    }
+    return inside / twoM - resolution * spread;
+}
+
+// Weight per neighboring community while one vertex (or community) is
+// scored: open addressing over a table of at least twice the entries being
+// summed, cleared through the list of used slots. A dense array per worker
+// would cost threads * n * 8 bytes; this is bounded by the largest degree.
+// Communities are listed in first-seen order.
+class CommunityWeights {
+public:
+    // Readies the table for up to `entries` distinct communities.
+    void reset(size_t entries) {
+        size_t size = 16;
+        while (size < 2 * entries) {
+            size <<= 1;
+        }
+        if (keys.size() < size) {
+            keys.assign(size, kEmpty);
+            values.assign(size, 0);
+        }
+        mask = size - 1;
+    }
+
+    void add(uint32_t community, double weight) {
+        size_t i = slot(community);
+        if (keys[i] == kEmpty) {
+            keys[i] = community;
+            used.push_back(i);
+        }
+        values[i] += weight;
+    }
+
+    double weight(uint32_t community) const {
+        size_t i = slot(community);
+        return keys[i] == kEmpty ? 0 : values[i];
+    }
+
+    size_t size() const { return used.size(); }
+    uint32_t community(size_t k) const { return keys[used[k]]; }
+    double weightAt(size_t k) const { return values[used[k]]; }
+
+    void clear() {
+        for (size_t i : used) {
+            keys[i] = kEmpty;
+            values[i] = 0;
+        }
+        used.clear();
+    }
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    size_t slot(uint32_t community) const {
+        size_t i = static_cast<size_t>((uint64_t(community) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+        while (keys[i] != kEmpty && keys[i] != community) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    std::vector<uint32_t> keys;
+    std::vector<double> values;
+    std::vector<size_t> used;
+    size_t mask = 0;
+};
+
+// Local moving on one level; membership starts as the identity and ends as
+// community IDs in [0, n). Each pass visits the vertices in kSubsets random
+// subsets: a subset decides its moves in parallel against the state left by
+// the previous one, then applies them, so results do not depend on the
+// thread count and neighbors rarely swap places. A singleton only joins
+// another singleton with a lower ID, which breaks the remaining swaps.
+inline double moveVertices(const View& graph, std::vector<uint32_t>& membership, double twoM, const Options& options,
+                           size_t level) {
+    constexpr unsigned kSubsets = 4;
+    size_t n = graph.n;
+    std::vector<double> strength(n);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            double k = 0;
+            for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                k += graph.weight(e);
+            }
+            strength[v] = k;
+        }
+    });
+    membership.resize(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        membership[v] = v;
+    }
+    std::vector<double> tot = strength;
+    std::vector<uint32_t> members(n, 1);
+
+    unsigned workers = parallel::blockCount(n);
+    std::vector<CommunityWeights> weightTo(workers);
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> moves(workers);
+
+    double quality = modularity(graph, membership, tot, twoM, options.resolution);
+    for (size_t pass = 0; pass < options.maxPasses; ++pass) {
+        CounterRng order(options.seed, (uint64_t(level) << 32) | pass);
+        size_t moved = 0;
+        for (unsigned subset = 0; subset < kSubsets; ++subset) {
+            parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned worker) {
+                CommunityWeights& weights = weightTo[worker];
+                moves[worker].clear();
+                for (size_t v = begin; v < end; ++v) {
+                    if (static_cast<unsigned>(order.uniformAt(v) * kSubsets) != subset) {
+                        continue;
+                    }
+                    weights.reset(graph.offsets[v + 1] - graph.offsets[v]);
+                    for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                        uint32_t u = graph.targets[e];
+                        if (u != v) {
+                            weights.add(membership[u], graph.weight(e));
+                        }
+                    }
+                    // Gain of joining c, up to a constant: weight into c minus
+                    // the expected weight for c's total.
+                    uint32_t from = membership[v];
+                    double scale = options.resolution * strength[v] / twoM;
+                    uint32_t best = from;
+                    double bestScore = weights.weight(from) - scale * (tot[from] - strength[v]);
+                    for (size_t k = 0; k < weights.size(); ++k) {
+                        uint32_t c = weights.community(k);
+                        double score = weights.weightAt(k) - scale * tot[c];
+                        if (c != from && score > bestScore) {
+                            best = c;
+                            bestScore = score;
+                        }
+                    }
+                    weights.clear();
+                    if (best != from && !(members[from] == 1 && members[best] == 1 && best > from)) {
+                        moves[worker].push_back({static_cast<uint32_t>(v), best});
+                    }
+                }
+            });
+            for (unsigned w = 0; w < workers; ++w) {
+                for (const auto& move : moves[w]) {
+                    uint32_t v = move.first, from = membership[v];
+                    tot[from] -= strength[v];
+                    members[from]--;
+                    tot[move.second] += strength[v];
+                    members[move.second]++;
+                    membership[v] = move.second;
+                }
+                moved += moves[w].size();
+            }
+        }
+        if (moved == 0) {
+            break;
+        }
+        double next = modularity(graph, membership, tot, twoM, options.resolution);
+        bool done = next - quality < options.minGain;
+        quality = next;
+        if (done) {
+            break;
+        }
+    }
+    return quality;
+}
+
+// Renumbers membership to [0, count) and returns the graph with one vertex
+// per community; parallel edges and inside edges are summed.
+inline Level aggregate(const View& graph, std::vector<uint32_t>& membership) {
+    size_t n = graph.n;
+    std::vector<uint32_t> renumber(n, UINT32_MAX);
+    uint32_t count = 0;
+    for (uint32_t v = 0; v < n; ++v) {
+        if (renumber[membership[v]] == UINT32_MAX) {
+            renumber[membership[v]] = count++;
+        }
+    }
+    std::vector<uint64_t> start(count + 1, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+        membership[v] = renumber[membership[v]];
+        start[membership[v] + 1]++;
+    }
+    for (size_t c = 0; c < count; ++c) {
+        start[c + 1] += start[c];
+    }
+    std::vector<uint32_t> byCommunity(n);
+    std::vector<uint64_t> fill(start.begin(), start.end() - 1);
+    for (uint32_t v = 0; v < n; ++v) {
+        byCommunity[fill[membership[v]]++] = v;
+    }
+
+    // Blocks are contiguous and in worker order, so the per-worker rows
+    // concatenate into the new CSR directly.
+    unsigned workers = parallel::blockCount(count, 256);
+    std::vector<Level> parts(workers);
+    std::vector<uint64_t> rowLength(count);
+    parallel::forBlocks(count, [&](size_t begin, size_t end, unsigned worker) {
+        CommunityWeights weights;
+        std::vector<std::pair<uint32_t, double>> row;
+        Level& part = parts[worker];
+        for (size_t c = begin; c < end; ++c) {
+            uint64_t entries = 0;
+            for (uint64_t i = start[c]; i < start[c + 1]; ++i) {
+                entries += graph.offsets[byCommunity[i] + 1] - graph.offsets[byCommunity[i]];
+            }
+            weights.reset(std::min<uint64_t>(entries, count));
+            for (uint64_t i = start[c]; i < start[c + 1]; ++i) {
+                uint32_t v = byCommunity[i];
+                for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                    weights.add(membership[graph.targets[e]], graph.weight(e));
+                }
+            }
+            row.clear();
+            for (size_t k = 0; k < weights.size(); ++k) {
+                row.push_back({weights.community(k), weights.weightAt(k)});
+            }
+            weights.clear();
+            std::sort(row.begin(), row.end());
+            for (const auto& entry : row) {
+                part.targets.push_back(entry.first);
+                part.weights.push_back(entry.second);
+            }
+            rowLength[c] = row.size();
+        }
+    }, 256);
+
+    Level next;
+    next.offsets.assign(count + 1, 0);
+    for (size_t c = 0; c < count; ++c) {
+        next.offsets[c + 1] = next.offsets[c] + rowLength[c];
+    }
+    for (Level& part : parts) {
+        next.targets.insert(next.targets.end(), part.targets.begin(), part.targets.end());
+        next.weights.insert(next.weights.end(), part.weights.begin(), part.weights.end());
+        part = Level();
+    }
+    return next;
+}
+
+} // namespace detail
+
+inline Result louvain(const CsrGraph& graph, const Options& options = {}) {
+    Result result;
+    size_t n = graph.rowCount();
+    result.community.resize(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        result.community[v] = v;
+    }
+    double twoM = static_cast<double>(graph.rowTargets().size());
+
+    if (twoM > 0) {
+        detail::Level level;
+        detail::View view{n, graph.rowOffsets().data(), graph.rowTargets().data(), nullptr};
+        std::vector<uint32_t> membership;
+        for (size_t depth = 0; depth < options.maxLevels; ++depth) {
+            double quality = detail::moveVertices(view, membership, twoM, options, depth);
+            detail::Level next = detail::aggregate(view, membership);
+            if (next.offsets.size() - 1 == view.n) {
+                break;
+            }
+            for (uint32_t& c : result.community) {
+                c = membership[c];
+            }
+            result.modularity.push_back(quality);
+            level = std::move(next);
+            view = level.view();
+        }
+    }
+
+    // Relabel by decreasing size, ties by lower ID.
+    std::vector<size_t> count(n, 0);
+    for (uint32_t c : result.community) {
+        count[c]++;
+    }
+    std::vector<uint32_t> order;
+    for (uint32_t c = 0; c < n; ++c) {
+        if (count[c] > 0) {
+            order.push_back(c);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return count[a] > count[b]; });
+    std::vector<uint32_t> label(n);
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        label[order[i]] = i;
+        result.sizes.push_back(count[order[i]]);
+    }
+    for (uint32_t& c : result.community) {
+        c = label[c];
+    }
+    return result;
+}
+
+} // namespace community
+
+#endif // COMMUNITY_H
@@ -0,0 +1,197 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "counter_rng.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Connected components with Afforest (Sutton et al., 2018): a lock-free
+// union-find is first linked along just two edges per vertex, which already
+// merges most of a power-law graph into one giant component. A sample then
+// identifies that component, and the remaining edges are only scanned for
+// vertices outside it. Near-linear, and most edges are never touched.
+namespace components {
+
+struct Result {
+    std::vector<uint32_t> component; // per dense vertex; 0 is the largest component
+    std::vector<size_t> sizes;       // per component, non-increasing
+};
+
+// Characteristic ID -> holders, most common first.
+using Histogram = std::vector<std::pair<uint32_t, size_t>>;
+
+namespace detail {
+
+inline uint32_t load(const std::vector<uint32_t>& parent, uint32_t v) {
+    return __atomic_load_n(&parent[v], __ATOMIC_RELAXED);
+}
+
+// Hooks the higher root under the lower one; retries when another worker
+// moved either tree first.
+inline void link(std::vector<uint32_t>& parent, uint32_t u, uint32_t v) {
+    uint32_t p1 = load(parent, u);
+    uint32_t p2 = load(parent, v);
+    while (p1 != p2) {
+        uint32_t high = std::max(p1, p2);
+        uint32_t low = std::min(p1, p2);
+        uint32_t parentOfHigh = load(parent, high);
+        if (parentOfHigh == low) {
+            break;
+        }
+        if (parentOfHigh == high &&
+            __atomic_compare_exchange_n(&parent[high], &parentOfHigh, low, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+        p1 = load(parent, load(parent, high));
+        p2 = load(parent, low);
+    }
+}
+
+inline void compress(std::vector<uint32_t>& parent) {
+    parallel::forBlocks(parent.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t up = load(parent, static_cast<uint32_t>(v));
+            uint32_t grand = load(parent, up);
+            while (grand != up) {
+                __atomic_store_n(&parent[v], grand, __ATOMIC_RELAXED);
+                up = grand;
+                grand = load(parent, up);
+            }
+        }
+    });
+}
+
+} // namespace detail
+
+inline Result connected(const CsrGraph& graph) {
+    constexpr size_t kNeighborRounds = 2;
+    constexpr size_t kSamples = 1024;
+
+    size_t n = graph.rowCount();
+    const std::vector<uint64_t>& offsets = graph.rowOffsets();
+    const std::vector<uint32_t>& targets = graph.rowTargets();
+    std::vector<uint32_t> parent(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        parent[v] = v;
+    }
+
+    for (size_t round = 0; round < kNeighborRounds; ++round) {
+        parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+            for (size_t v = begin; v < end; ++v) {
+                if (offsets[v] + round < offsets[v + 1]) {
+                    detail::link(parent, static_cast<uint32_t>(v), targets[offsets[v] + round]);
+                }
+            }
+        });
+        detail::compress(parent);
+    }
+
+    // Most frequent root among sampled vertices: very likely the giant one.
+    uint32_t giant = 0;
+    if (n > 0) {
+        std::unordered_map<uint32_t, size_t> seen;
+        CounterRng rng(0, 0);
+        size_t best = 0;
+        for (size_t i = 0; i < kSamples; ++i) {
+            uint32_t root = parent[rng.below(n)];
+            size_t count = ++seen[root];
+            if (count > best || (count == best && root < giant)) {
+                best = count;
+                giant = root;
+            }
+        }
+    }
+
+    // Vertices already in the giant component skip their remaining edges; an
+    // edge into it from outside is still seen from the outside endpoint.
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            if (detail::load(parent, static_cast<uint32_t>(v)) == giant) {
+                continue;
+            }
+            for (uint64_t e = offsets[v] + kNeighborRounds; e < offsets[v + 1]; ++e) {
+                detail::link(parent, static_cast<uint32_t>(v), targets[e]);
+            }
+        }
+    });
+    detail::compress(parent);
+
+    // Relabel roots 0.. by decreasing size.
+    Result result;
+    std::vector<size_t> rootSize(n, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+        rootSize[parent[v]]++;
+    }
+    std::vector<uint32_t> roots;
+    for (uint32_t v = 0; v < n; ++v) {
+        if (rootSize[v] > 0) {
+            roots.push_back(v);
+        }
+    }
+    std::stable_sort(roots.begin(), roots.end(), [&](uint32_t a, uint32_t b) { return rootSize[a] > rootSize[b]; });
+    std::vector<uint32_t> label(n);
+    result.sizes.resize(roots.size());
+    for (uint32_t c = 0; c < roots.size(); ++c) {
+        label[roots[c]] = c;
+        result.sizes[c] = rootSize[roots[c]];
+    }
+    result.component.resize(n);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            result.component[v] = label[parent[v]];
+        }
+    });
+    return result;
+}
+
+// Per group, how many vertices hold each characteristic, where labels[v] in
+// [0, groupCount) is v's component (or community). chars(v) gives v's IDs as
+// a pointer pair. Pairs are gathered per worker, then sorted, so there is no
+// groups x characteristics table.
+template <typename Chars>
+std::vector<Histogram> histograms(const std::vector<uint32_t>& labels, size_t groupCount, Chars chars) {
+    size_t n = labels.size();
+    std::vector<std::vector<uint64_t>> parts(parallel::blockCount(n));
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned worker) {
+        for (size_t v = begin; v < end; ++v) {
+            auto run = chars(static_cast<uint32_t>(v));
+            for (const uint32_t* p = run.first; p != run.second; ++p) {
+                parts[worker].push_back((uint64_t(labels[v]) << 32) | *p);
+            }
+        }
+    });
+    std::vector<uint64_t> keys;
+    for (auto& part : parts) {
+        keys.insert(keys.end(), part.begin(), part.end());
+        part = {};
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<Histogram> byGroup(groupCount);
+    for (size_t i = 0; i < keys.size();) {
+        size_t j = i;
+        while (j < keys.size() && keys[j] == keys[i]) {
+            ++j;
+        }
+        byGroup[keys[i] >> 32].push_back({static_cast<uint32_t>(keys[i]), j - i});
+        i = j;
+    }
+    for (Histogram& histogram : byGroup) {
+        std::stable_sort(histogram.begin(), histogram.end(),
+                         [](const std::pair<uint32_t, size_t>& a, const std::pair<uint32_t, size_t>& b) {
+                             return a.second > b.second;
+                         });
+    }
+    return byGroup;
+}
+
+} // namespace components
+
+#endif // COMPONENTS_H
@@ -0,0 +1,44 @@
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <cstdint>
+
+// Counter-based random numbers: output i of stream s under key k is a hash
+// of (k, s, i), so any draw can be reproduced from its coordinates alone.
+// Giving each trial, sample or source its own stream makes parallel results
+// independent of how work is split across threads.
+class CounterRng {
+public:
+    CounterRng(uint64_t key, uint64_t stream) : streamKey(mix(key ^ mix(stream * kGolden + 1))) {}
+
+    uint64_t next() { return mix(streamKey + (++counter) * kGolden); }
+    double uniform() { return unit(next()); }
+
+    // Uniform in [0, bound) without modulo bias worth caring about for
+    // bounds far below 2^64.
+    uint64_t below(uint64_t bound) { return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64); }
+
+    // Random value tied to `index` rather than to the draw order, for lazily
+    // drawn per-item values such as LT thresholds.
+    double uniformAt(uint64_t index) const { return unit(mix(streamKey ^ mix(index * kGolden + 2))); }
+
+    // SplitMix64 finalizer; strong enough that consecutive counters give
+    // independent-looking 64-bit outputs.
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+private:
+    static constexpr uint64_t kGolden = 0x9E3779B97F4A7C15ULL;
+
+    static double unit(uint64_t bits) { return static_cast<double>(bits >> 11) * 0x1.0p-53; }
+
+    uint64_t streamKey;
+    uint64_t counter = 0;
+};
+
+#endif // COUNTER_RNG_H
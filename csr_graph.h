@@ -0,0 +1,315 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Read-only view of one adjacency row without copying it: the frozen CSR
+// part, then any overflow neighbors. Valid until the graph is next modified.
+class NeighborSpan {
+public:
+    class iterator {
+    public:
+        iterator(const uint32_t* p, const uint32_t* firstEnd, const uint32_t* second)
+            : p(p), firstEnd(firstEnd), second(second) {}
+
+        uint32_t operator*() const { return *p; }
+        iterator& operator++() {
+            if (++p == firstEnd) {
+                p = second;
+            }
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return p == other.p; }
+        bool operator!=(const iterator& other) const { return p != other.p; }
+
+    private:
+        const uint32_t* p;
+        const uint32_t* firstEnd;
+        const uint32_t* second;
+    };
+
+    NeighborSpan() = default;
+    NeighborSpan(const uint32_t* first, const uint32_t* firstEnd, const uint32_t* second, const uint32_t* secondEnd)
+        : first(first), firstEnd(firstEnd), second(second), secondEnd(secondEnd) {}
+
+    iterator begin() const { return iterator(first != firstEnd ? first : second, firstEnd, second); }
+    iterator end() const { return iterator(secondEnd, firstEnd, second); }
+    size_t size() const { return static_cast<size_t>((firstEnd - first) + (secondEnd - second)); }
+    bool empty() const { return size() == 0; }
+
+private:
+    const uint32_t* first = nullptr;
+    const uint32_t* firstEnd = nullptr;
+    const uint32_t* second = nullptr;
+    const uint32_t* secondEnd = nullptr;
+};
+
+// Undirected adjacency over dense vertex indexes in compressed-sparse-row
+// form: row v is targets[offsets[v] .. offsets[v + 1]), sorted ascending.
+// Bulk loads go into a staging buffer and are folded in by freeze(); addEdge
+// after that lands in a small sorted overflow delta that is merged back once
+// it grows.
+class CsrGraph {
+public:
+    void stageEdge(uint32_t v1, uint32_t v2) { staging.emplace_back(v1, v2); }
+
+    void stageEdges(const std::vector<std::pair<uint32_t, uint32_t>>& edges) {
+        staging.insert(staging.end(), edges.begin(), edges.end());
+    }
+
+    void addEdge(uint32_t v1, uint32_t v2) {
+        if (hasEdge(v1, v2)) {
+            return;
+        }
+        insertDelta(v1, v2);
+        if (v1 != v2) {
+            insertDelta(v2, v1);
+        }
+        if (deltaEntries > std::max<size_t>(kMinDeltaBeforeMerge, targets.size() / 8)) {
+            freeze(rowCount());
+        }
+    }
+
+    // Folds the delta and everything staged into the CSR arrays,
+    // deduplicating as the original hash-set adjacency did. Only the new
+    // entries are sorted; they are then merged row by row into the frozen
+    // rows, which are already sorted, so a fold is linear in the edge count
+    // rather than a resort of every edge. The result has at least
+    // `vertexCount` rows so every dense index is addressable.
+    void freeze(size_t vertexCount) {
+        size_t rows = std::max(vertexCount, rowCount());
+        if (staging.empty() && delta.empty()) {
+            addRows(rows);
+            return;
+        }
+        std::vector<uint64_t> keys;
+        keys.reserve(deltaEntries + 2 * staging.size());
+        for (const auto& pair : delta) {
+            rows = std::max<size_t>(rows, pair.first + 1);
+            for (uint32_t neighbor : pair.second) {
+                keys.push_back(key(pair.first, neighbor));
+            }
+        }
+        for (const auto& edge : staging) {
+            rows = std::max<size_t>(rows, std::max(edge.first, edge.second) + size_t(1));
+            keys.push_back(key(edge.first, edge.second));
+            if (edge.first != edge.second) {
+                keys.push_back(key(edge.second, edge.first));
+            }
+        }
+        staging.clear();
+        staging.shrink_to_fit();
+        delta.clear();
+        deltaEntries = 0;
+
+        radixSort(keys);
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<uint64_t> mergedOffsets(rows + 1, 0);
+        std::vector<uint32_t> mergedTargets;
+        mergedTargets.reserve(targets.size() + keys.size());
+        size_t k = 0;
+        for (uint32_t v = 0; v < rows; ++v) {
+            const uint32_t* p = v < rowCount() ? rowBegin(v) : nullptr;
+            const uint32_t* pEnd = v < rowCount() ? rowEnd(v) : nullptr;
+            for (; k < keys.size() && from(keys[k]) == v; ++k) {
+                uint32_t neighbor = to(keys[k]);
+                for (; p != pEnd && *p < neighbor; ++p) {
+                    mergedTargets.push_back(*p);
+                }
+                if (p != pEnd && *p == neighbor) {
+                    ++p;
+                }
+                mergedTargets.push_back(neighbor);
+            }
+            mergedTargets.insert(mergedTargets.end(), p, pEnd);
+            mergedOffsets[v + 1] = mergedTargets.size();
+        }
+        offsets.swap(mergedOffsets);
+        targets.swap(mergedTargets);
+    }
+
+    // Appends empty rows up to `vertexCount` without folding anything pending,
+    // so a new vertex costs one offset rather than a rebuild.
+    void addRows(size_t vertexCount) {
+        if (vertexCount > rowCount()) {
+            offsets.resize(vertexCount + 1, offsets.back());
+        }
+    }
+
+    // Adopts prebuilt arrays (e.g. from a snapshot); rows must be sorted.
+    void assign(std::vector<uint64_t> rowOffsets, std::vector<uint32_t> rowTargets) {
+        clear();
+        offsets = std::move(rowOffsets);
+        targets = std::move(rowTargets);
+    }
+
+    void clear() {
+        offsets.assign(1, 0);
+        targets.clear();
+        staging.clear();
+        delta.clear();
+        deltaEntries = 0;
+    }
+
+    bool hasPending() const { return !staging.empty() || !delta.empty(); }
+
+    bool hasEdge(uint32_t v1, uint32_t v2) const {
+        if (v1 < rowCount() && std::binary_search(rowBegin(v1), rowEnd(v1), v2)) {
+            return true;
+        }
+        auto it = delta.find(v1);
+        return it != delta.end() && std::binary_search(it->second.begin(), it->second.end(), v2);
+    }
+
+    size_t degree(uint32_t v) const {
+        size_t result = v < rowCount() ? static_cast<size_t>(offsets[v + 1] - offsets[v]) : 0;
+        if (!delta.empty()) {
+            auto it = delta.find(v);
+            if (it != delta.end()) {
+                result += it->second.size();
+            }
+        }
+        return result;
+    }
+
+    // Visits the frozen row (sorted) and then any overflow neighbors.
+    template <typename F>
+    void forEachNeighbor(uint32_t v, F f) const {
+        if (v < rowCount()) {
+            for (const uint32_t* p = rowBegin(v); p != rowEnd(v); ++p) {
+                f(*p);
+            }
+        }
+        if (!delta.empty()) {
+            auto it = delta.find(v);
+            if (it != delta.end()) {
+                for (uint32_t neighbor : it->second) {
+                    f(neighbor);
+                }
+            }
+        }
+    }
+
+    // Row v as a span, in forEachNeighbor order.
+    NeighborSpan neighbors(uint32_t v) const {
+        const uint32_t* first = v < rowCount() ? rowBegin(v) : nullptr;
+        const uint32_t* firstEnd = v < rowCount() ? rowEnd(v) : nullptr;
+        if (!delta.empty()) {
+            auto it = delta.find(v);
+            if (it != delta.end() && !it->second.empty()) {
+                return NeighborSpan(first, firstEnd, it->second.data(), it->second.data() + it->second.size());
+            }
+        }
+        return NeighborSpan(first, firstEnd, nullptr, nullptr);
+    }
+
+    // Same order as forEachNeighbor, but stops at the first neighbor for which
+    // f returns true.
+    template <typename F>
+    bool anyNeighbor(uint32_t v, F f) const {
+        if (v < rowCount()) {
+            for (const uint32_t* p = rowBegin(v); p != rowEnd(v); ++p) {
+                if (f(*p)) {
+                    return true;
+                }
+            }
+        }
+        if (!delta.empty()) {
+            auto it = delta.find(v);
+            if (it != delta.end()) {
+                for (uint32_t neighbor : it->second) {
+                    if (f(neighbor)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // Visits every vertex with at least one edge as f(v, degree), in index order
+    // for the frozen rows.
+    template <typename F>
+    void forEachVertex(F f) const {
+        for (uint32_t v = 0; v < rowCount(); ++v) {
+            size_t d = degree(v);
+            if (d > 0) {
+                f(v, d);
+            }
+        }
+        for (const auto& pair : delta) {
+            if (pair.first >= rowCount()) {
+                f(pair.first, pair.second.size());
+            }
+        }
+    }
+
+    // Frozen rows only; callers that need the delta folded in call freeze() first.
+    size_t rowCount() const { return offsets.size() - 1; }
+    const uint32_t* rowBegin(uint32_t v) const { return targets.data() + offsets[v]; }
+    const uint32_t* rowEnd(uint32_t v) const { return targets.data() + offsets[v + 1]; }
+    const std::vector<uint64_t>& rowOffsets() const { return offsets; }
+    const std::vector<uint32_t>& rowTargets() const { return targets; }
+
+    size_t memoryBytes() const {
+        return offsets.capacity() * sizeof(uint64_t) + targets.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    static constexpr size_t kMinDeltaBeforeMerge = 4096;
+
+    static uint64_t key(uint32_t from, uint32_t to) { return (uint64_t(from) << 32) | to; }
+    static uint32_t from(uint64_t k) { return uint32_t(k >> 32); }
+    static uint32_t to(uint64_t k) { return uint32_t(k); }
+
+    // LSD radix sort in 16-bit digits; digits that are constant across all
+    // keys are skipped, which is common for small vertex counts.
+    static void radixSort(std::vector<uint64_t>& keys) {
+        if (keys.size() < 256) {
+            std::sort(keys.begin(), keys.end());
+            return;
+        }
+        std::vector<uint64_t> buffer(keys.size());
+        std::vector<size_t> count(1 << 16);
+        for (int shift = 0; shift < 64; shift += 16) {
+            std::fill(count.begin(), count.end(), 0);
+            for (uint64_t k : keys) {
+                count[(k >> shift) & 0xFFFF]++;
+            }
+            if (count[(keys[0] >> shift) & 0xFFFF] == keys.size()) {
+                continue;
+            }
+            size_t sum = 0;
+            for (auto& c : count) {
+                size_t n = c;
+                c = sum;
+                sum += n;
+            }
+            for (uint64_t k : keys) {
+                buffer[count[(k >> shift) & 0xFFFF]++] = k;
+            }
+            keys.swap(buffer);
+        }
+    }
+
+    void insertDelta(uint32_t v, uint32_t neighbor) {
+        auto& row = delta[v];
+        row.insert(std::lower_bound(row.begin(), row.end(), neighbor), neighbor);
+        ++deltaEntries;
+    }
+
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint32_t> targets;
+
+    std::vector<std::pair<uint32_t, uint32_t>> staging;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> delta;
+    size_t deltaEntries = 0;
+};
+
+#endif // CSR_GRAPH_H
@@ -0,0 +1,199 @@
+#ifndef DIFFUSION_H
+#define DIFFUSION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "counter_rng.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Monte Carlo simulation of probabilistic spread from a seed set, under the
+// independent cascade (IC) or linear threshold (LT) model.
+//
+// Randomness is counter based: every draw is a hash of (seed, trial, counter),
+// so a trial produces the same cascade no matter which worker runs it and the
+// totals are reproducible for any thread count.
+namespace diffusion {
+
+enum class Model { IndependentCascade, LinearThreshold };
+
+struct Options {
+    Model model = Model::IndependentCascade;
+    size_t trials = 1000;
+    uint64_t seed = 1;
+    int maxHops = -1; // negative means run each cascade to completion
+};
+
+// Edge probability for IC, and the (normalized) influence weight for LT:
+// base plus a bonus for every characteristic the two endpoints share. With
+// weightedCascade the result is divided by the receiving node's degree, so
+// hubs are not flooded (the usual default in influence maximization).
+struct EdgeProbability {
+    double base = 0.1;
+    double perSharedCharacteristic = 0.0;
+    bool weightedCascade = false;
+};
+
+struct Stat {
+    double mean = 0;
+    double variance = 0; // sample variance over trials
+};
+
+struct Summary {
+    size_t trials = 0;
+    Stat reach;                       // activated vertices per trial, seeds included
+    std::vector<Stat> byCharacteristic; // activated holders of each characteristic ID
+};
+
+namespace detail {
+
+// Per-worker buffers, reset through the touched lists so a trial costs
+// O(cascade size) rather than O(vertex count).
+struct Workspace {
+    std::vector<uint32_t> stamp;     // == trial + 1 when active in that trial
+    std::vector<double> load;        // LT: accumulated incoming weight
+    std::vector<uint32_t> loaded;    // LT: vertices with load != 0
+    std::vector<uint32_t> active;    // activation order, seeds first
+    std::vector<uint32_t> charHits;  // per characteristic, current trial
+    std::vector<uint32_t> charTouched;
+    // Counts are integers, so the moments are kept exactly and variance
+    // does not suffer from cancellation when reach barely varies.
+    uint64_t reachSum = 0, reachSquares = 0;
+    std::vector<uint64_t> charSum, charSquares;
+};
+
+inline Stat finish(uint64_t sum, uint64_t squares, size_t trials) {
+    Stat stat;
+    if (trials == 0) {
+        return stat;
+    }
+    long double mean = static_cast<long double>(sum) / trials;
+    stat.mean = static_cast<double>(mean);
+    if (trials > 1) {
+        long double spread = static_cast<long double>(squares) - static_cast<long double>(sum) * mean;
+        stat.variance = static_cast<double>(std::max<long double>(0, spread / (trials - 1)));
+    }
+    return stat;
+}
+
+} // namespace detail
+
+// Runs options.trials cascades over the frozen rows of `graph`.
+//   weights[i]  probability of edge i (aligned with graph.rowTargets()).
+//   inWeight[v] LT normalizer: sum of probabilities into v, at least 1.
+//   chars(v)    v's characteristic IDs as a pointer pair (may be empty).
+template <typename Chars>
+Summary simulate(const CsrGraph& graph, const std::vector<float>& weights, const std::vector<double>& inWeight,
+                 const std::vector<uint32_t>& seeds, size_t characteristicCount, Chars chars,
+                 const Options& options) {
+    size_t n = graph.rowCount();
+    std::vector<uint32_t> uniqueSeeds;
+    for (uint32_t seed : seeds) {
+        if (seed < n) {
+            uniqueSeeds.push_back(seed);
+        }
+    }
+    std::sort(uniqueSeeds.begin(), uniqueSeeds.end());
+    uniqueSeeds.erase(std::unique(uniqueSeeds.begin(), uniqueSeeds.end()), uniqueSeeds.end());
+
+    std::vector<detail::Workspace> spaces(parallel::blockCount(options.trials, 1));
+    parallel::forBlocks(options.trials, [&](size_t begin, size_t end, unsigned worker) {
+        detail::Workspace& ws = spaces[worker];
+        ws.stamp.assign(n, 0);
+        ws.charHits.assign(characteristicCount, 0);
+        ws.charSum.assign(characteristicCount, 0);
+        ws.charSquares.assign(characteristicCount, 0);
+        if (options.model == Model::LinearThreshold) {
+            ws.load.assign(n, 0);
+        }
+
+        for (size_t trial = begin; trial < end; ++trial) {
+            uint32_t mark = static_cast<uint32_t>(trial + 1);
+            CounterRng rng(options.seed, trial);
+            ws.active.assign(uniqueSeeds.begin(), uniqueSeeds.end());
+            for (uint32_t seed : uniqueSeeds) {
+                ws.stamp[seed] = mark;
+            }
+
+            // Breadth-first by hop so maxHops means the same for both models.
+            size_t levelBegin = 0;
+            for (int hop = 0; levelBegin < ws.active.size() && (options.maxHops < 0 || hop < options.maxHops); ++hop) {
+                size_t levelEnd = ws.active.size();
+                for (size_t i = levelBegin; i < levelEnd; ++i) {
+                    uint32_t u = ws.active[i];
+                    for (uint64_t e = graph.rowOffsets()[u]; e < graph.rowOffsets()[u + 1]; ++e) {
+                        uint32_t v = graph.rowTargets()[e];
+                        if (ws.stamp[v] == mark) {
+                            continue;
+                        }
+                        bool fire;
+                        if (options.model == Model::IndependentCascade) {
+                            fire = rng.uniform() < weights[e];
+                        } else {
+                            if (ws.load[v] == 0) {
+                                ws.loaded.push_back(v);
+                            }
+                            ws.load[v] += weights[e] / inWeight[v];
+                            fire = ws.load[v] >= rng.uniformAt(v);
+                        }
+                        if (fire) {
+                            ws.stamp[v] = mark;
+                            ws.active.push_back(v);
+                        }
+                    }
+                }
+                levelBegin = levelEnd;
+            }
+
+            uint64_t reach = ws.active.size();
+            ws.reachSum += reach;
+            ws.reachSquares += reach * reach;
+            for (uint32_t v : ws.active) {
+                auto run = chars(v);
+                for (const uint32_t* p = run.first; p != run.second; ++p) {
+                    if (ws.charHits[*p]++ == 0) {
+                        ws.charTouched.push_back(*p);
+                    }
+                }
+            }
+            for (uint32_t c : ws.charTouched) {
+                uint64_t hits = ws.charHits[c];
+                ws.charSum[c] += hits;
+                ws.charSquares[c] += hits * hits;
+                ws.charHits[c] = 0;
+            }
+            ws.charTouched.clear();
+            for (uint32_t v : ws.loaded) {
+                ws.load[v] = 0;
+            }
+            ws.loaded.clear();
+        }
+    }, 1);
+
+    Summary summary;
+    summary.trials = options.trials;
+    uint64_t reachSum = 0, reachSquares = 0;
+    std::vector<uint64_t> charSum(characteristicCount, 0), charSquares(characteristicCount, 0);
+    for (const auto& ws : spaces) {
+        reachSum += ws.reachSum;
+        reachSquares += ws.reachSquares;
+        for (size_t c = 0; c < ws.charSum.size(); ++c) {
+            charSum[c] += ws.charSum[c];
+            charSquares[c] += ws.charSquares[c];
+        }
+    }
+    summary.reach = detail::finish(reachSum, reachSquares, options.trials);
+    summary.byCharacteristic.resize(characteristicCount);
+    for (size_t c = 0; c < characteristicCount; ++c) {
+        summary.byCharacteristic[c] = detail::finish(charSum[c], charSquares[c], options.trials);
+    }
+    return summary;
+}
+
+} // namespace diffusion
+
+#endif // DIFFUSION_H
@@ -0,0 +1,74 @@
+#ifndef EDGE_INGEST_H
+#define EDGE_INGEST_H
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.h"
+#include "parallel.h"
+
+// Parallel parser for the edge section of nodes.txt. The section is cut into
+// byte ranges on newline boundaries and each range is parsed by its own
+// parallel::forBlocks worker into a private buffer; the caller merges the
+// buffers in one bulk step.
+namespace ingest {
+
+// Below this many bytes per worker the thread start-up costs more than it saves.
+constexpr size_t kMinBytesPerThread = 1 << 20;
+
+struct EdgeChunk {
+    std::vector<std::pair<int, int>> edges;
+    std::vector<int> badLines; // chunk-relative, 0-based
+    int lineCount = 0;
+};
+
+inline void parseEdgeRange(const char* p, const char* end, EdgeChunk& chunk) {
+    // Edge lines are typically around eight bytes; a rough reserve avoids most regrowth.
+    chunk.edges.reserve(static_cast<size_t>(end - p) / 8);
+    while (p < end) {
+        std::string_view line = scan::nextLine(p, end);
+        int lineIndex = chunk.lineCount++;
+        if (line == "edges") {
+            continue;
+        }
+        const char* q = line.data();
+        const char* lineEnd = q + line.size();
+        int id1, id2;
+        if (!scan::parseInt(q, lineEnd, id1) || !scan::parseInt(q, lineEnd, id2)) {
+            chunk.badLines.push_back(lineIndex);
+            continue;
+        }
+        chunk.edges.emplace_back(id1, id2);
+    }
+}
+
+// Splits [begin, end) into one byte block per worker (see parallel.h), moves
+// each block boundary to just after the next newline, and parses the blocks
+// concurrently. A block that a single long line swallows comes back empty.
+inline std::vector<EdgeChunk> parseEdges(const char* begin, const char* end,
+                                         unsigned threads = parallel::threadCount()) {
+    size_t bytes = static_cast<size_t>(end - begin);
+    auto cut = [&](size_t offset) -> const char* {
+        if (offset == 0) {
+            return begin;
+        }
+        if (offset >= bytes) {
+            return end;
+        }
+        const char* from = begin + offset - 1;
+        const char* nl = static_cast<const char*>(memchr(from, '\n', static_cast<size_t>(end - from)));
+        return nl ? nl + 1 : end;
+    };
+    std::vector<EdgeChunk> chunks(parallel::blockCount(bytes, kMinBytesPerThread, threads));
+    parallel::forBlocks(bytes, [&](size_t first, size_t last, unsigned worker) {
+        parseEdgeRange(cut(first), cut(last), chunks[worker]);
+    }, kMinBytesPerThread, threads);
+    return chunks;
+}
+
+} // namespace ingest
+
+#endif // EDGE_INGEST_H
@@ -0,0 +1,310 @@
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "mapped_file.h"
+
+// Versioned binary snapshot of a SocialNetwork. Everything is a flat array so
+// a load is one mmap, a checksum pass and bulk copies; no text is parsed.
+//
+// Layout: a fixed Header, then the sections listed in Section, each starting
+// on an 8-byte boundary. Offsets in the header are from the start of the file.
+// Integers are stored in host byte order; byteOrder rejects foreign files.
+namespace snapshot {
+
+constexpr char kMagic[8] = {'S', 'N', 'G', 'R', 'A', 'P', 'H', '\0'};
+constexpr uint32_t kVersion = 3;
+constexpr uint32_t kByteOrder = 0x01020304;
+
+// Every per-vertex section is indexed by the dense vertex index.
+enum Section : uint32_t {
+    VertexIds,        // int32[vertexCount], external ID of each dense index
+    VertexFlags,      // uint8[vertexCount], kDeclared if it had a node line
+    NodeCharOffsets,  // uint32[vertexCount + 1] into NodeCharIds
+    NodeCharIds,      // uint32[], sorted per vertex, indexes the dictionary
+    DictOffsets,      // uint32[dictSize + 1] into DictBytes
+    DictBytes,        // char[], dictionary strings back to back
+    AdjOffsets,       // uint64[vertexCount + 1] into AdjTargets
+    AdjTargets,       // uint32[], dense indexes, ascending per row
+    LookalikeParams,  // uint64[3]: hashes, bands, seed; empty if no signatures
+    LookalikeRows,    // uint32[vertexCount * hashes], MinHash signatures
+    SectionCount
+};
+
+constexpr uint8_t kDeclared = 1;
+
+struct SectionEntry {
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+    uint64_t checksum; // of every byte after the header
+    SectionEntry sections[SectionCount];
+};
+
+// Flat form of a network, filled by SocialNetwork before writing.
+struct Data {
+    std::vector<int32_t> vertexIds;
+    std::vector<uint8_t> vertexFlags;
+    std::vector<uint32_t> nodeCharOffsets{0};
+    std::vector<uint32_t> nodeCharIds;
+    std::vector<uint32_t> dictOffsets{0};
+    std::vector<char> dictBytes;
+    std::vector<uint64_t> adjOffsets{0};
+    std::vector<uint32_t> adjTargets;
+    std::vector<uint64_t> lookalikeParams;
+    std::vector<uint32_t> lookalikeRows;
+};
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// Four independent multiply-rotate lanes over 8-byte words, so the check runs
+// near memory bandwidth instead of one dependent step per byte.
+inline uint64_t checksum(const char* p, size_t n) {
+    const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    uint64_t lanes[4] = {prime1, prime2, ~prime1, ~prime2};
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        for (int l = 0; l < 4; ++l) {
+            uint64_t word;
+            std::memcpy(&word, p + i + 8 * l, 8);
+            lanes[l] = rotl(lanes[l] + word * prime2, 31) * prime1;
+        }
+    }
+    uint64_t h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18) + n;
+    for (; i < n; ++i) {
+        h = rotl(h ^ (static_cast<uint8_t>(p[i]) * prime1), 11) * prime2;
+    }
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    return h;
+}
+
+inline uint64_t alignUp(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+template <typename T>
+void addSection(std::vector<char>& out, Header& header, Section section, const std::vector<T>& values) {
+    out.resize(alignUp(out.size()), 0);
+    header.sections[section].offset = out.size();
+    header.sections[section].bytes = values.size() * sizeof(T);
+    const char* bytes = reinterpret_cast<const char*>(values.data());
+    out.insert(out.end(), bytes, bytes + values.size() * sizeof(T));
+}
+
+// Writes to "<path>.tmp" and renames, so a crash never leaves a torn snapshot
+// that looks newer than the text file.
+inline bool write(const std::string& path, const Data& data) {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrder;
+
+    std::vector<char> out(sizeof(Header), 0);
+    addSection(out, header, VertexIds, data.vertexIds);
+    addSection(out, header, VertexFlags, data.vertexFlags);
+    addSection(out, header, NodeCharOffsets, data.nodeCharOffsets);
+    addSection(out, header, NodeCharIds, data.nodeCharIds);
+    addSection(out, header, DictOffsets, data.dictOffsets);
+    addSection(out, header, DictBytes, data.dictBytes);
+    addSection(out, header, AdjOffsets, data.adjOffsets);
+    addSection(out, header, AdjTargets, data.adjTargets);
+    addSection(out, header, LookalikeParams, data.lookalikeParams);
+    addSection(out, header, LookalikeRows, data.lookalikeRows);
+    out.resize(alignUp(out.size()), 0);
+
+    header.fileSize = out.size();
+    header.checksum = checksum(out.data() + sizeof(Header), out.size() - sizeof(Header));
+    std::memcpy(out.data(), &header, sizeof(Header));
+
+    std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+struct Span {
+    const T* ptr = nullptr;
+    size_t count = 0;
+
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    size_t size() const { return count; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+};
+
+// Read-only view of a mapped snapshot. open() validates the header, section
+// bounds, checksum and row contents; after that the accessors point straight
+// into the map.
+class View {
+public:
+    bool open(const std::string& path, std::string& error) {
+        if (!file.open(path)) {
+            error = "cannot open " + path;
+            return false;
+        }
+        if (file.size() < sizeof(Header)) {
+            error = "file too small";
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+            error = "bad magic";
+            return false;
+        }
+        if (header.byteOrder != kByteOrder) {
+            error = "written on a machine with a different byte order";
+            return false;
+        }
+        if (header.version != kVersion) {
+            error = "unsupported version " + std::to_string(header.version);
+            return false;
+        }
+        if (header.fileSize != file.size()) {
+            error = "truncated file";
+            return false;
+        }
+        for (const auto& section : header.sections) {
+            if (section.offset % 8 != 0 || section.offset > file.size() ||
+                section.bytes > file.size() - section.offset) {
+                error = "section out of bounds";
+                return false;
+            }
+        }
+        if (checksum(file.data() + sizeof(Header), file.size() - sizeof(Header)) != header.checksum) {
+            error = "checksum mismatch";
+            return false;
+        }
+        size_t n = vertexIds().size();
+        if (vertexFlags().size() != n ||
+            nodeCharOffsets().size() != n + 1 ||
+            dictOffsets().size() == 0 ||
+            adjOffsets().size() != n + 1 ||
+            nodeCharOffsets()[n] != nodeCharIds().size() ||
+            dictOffsets()[dictSize()] != dictBytes().size() ||
+            adjOffsets()[n] != adjTargets().size() ||
+            (lookalikeParams().size() != 0 && lookalikeParams().size() != 3) ||
+            (lookalikeParams().size() == 0 && lookalikeRows().size() != 0) ||
+            (lookalikeParams().size() == 3 && lookalikeRows().size() != n * lookalikeParams()[0])) {
+            error = "inconsistent section sizes";
+            return false;
+        }
+        // A checksum only proves the bytes are the ones written. Every
+        // analytic indexes and binary-searches these rows, so their contents
+        // are checked before anything reads them.
+        auto dict = dictOffsets();
+        for (size_t i = 0; i + 1 < dict.size(); ++i) {
+            if (dict[i] > dict[i + 1]) {
+                error = "bad dictionary offsets";
+                return false;
+            }
+        }
+        if (!validRows(nodeCharOffsets(), nodeCharIds(), dictSize())) {
+            error = "bad characteristic rows";
+            return false;
+        }
+        if (!validRows(adjOffsets(), adjTargets(), n)) {
+            error = "bad adjacency rows";
+            return false;
+        }
+        return true;
+    }
+
+    Span<int32_t> vertexIds() const { return get<int32_t>(VertexIds); }
+    Span<uint8_t> vertexFlags() const { return get<uint8_t>(VertexFlags); }
+    Span<uint32_t> nodeCharOffsets() const { return get<uint32_t>(NodeCharOffsets); }
+    Span<uint32_t> nodeCharIds() const { return get<uint32_t>(NodeCharIds); }
+    Span<uint32_t> dictOffsets() const { return get<uint32_t>(DictOffsets); }
+    Span<char> dictBytes() const { return get<char>(DictBytes); }
+    Span<uint64_t> adjOffsets() const { return get<uint64_t>(AdjOffsets); }
+    Span<uint32_t> adjTargets() const { return get<uint32_t>(AdjTargets); }
+    Span<uint64_t> lookalikeParams() const { return get<uint64_t>(LookalikeParams); }
+    Span<uint32_t> lookalikeRows() const { return get<uint32_t>(LookalikeRows); }
+
+    size_t dictSize() const { return dictOffsets().size() - 1; }
+
+    std::string_view dictEntry(uint32_t id) const {
+        auto offsets = dictOffsets();
+        return std::string_view(dictBytes().ptr + offsets[id], offsets[id + 1] - offsets[id]);
+    }
+
+private:
+    // Offsets non-decreasing, and each row strictly ascending with every
+    // value below `limit`. The last offset was already matched to the size.
+    template <typename Offset>
+    static bool validRows(Span<Offset> offsets, Span<uint32_t> values, size_t limit) {
+        for (size_t v = 0; v + 1 < offsets.size(); ++v) {
+            if (offsets[v] > offsets[v + 1]) {
+                return false;
+            }
+            for (Offset i = offsets[v]; i < offsets[v + 1]; ++i) {
+                if (values[i] >= limit || (i > offsets[v] && values[i - 1] >= values[i])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    Span<T> get(Section section) const {
+        const SectionEntry& entry = header.sections[section];
+        return Span<T>{reinterpret_cast<const T*>(file.data() + entry.offset), entry.bytes / sizeof(T)};
+    }
+
+    MappedFile file;
+    Header header;
+};
+
+// "nodes.txt" -> "nodes.snap"
+inline std::string pathFor(const std::string& textPath) {
+    size_t slash = textPath.find_last_of('/');
+    size_t dot = textPath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return textPath + ".snap";
+    }
+    return textPath.substr(0, dot) + ".snap";
+}
+
+// True when the snapshot exists and was written no earlier than the text file.
+inline bool isFresh(const std::string& snapshotPath, const std::string& textPath) {
+    struct stat snap, text;
+    if (stat(snapshotPath.c_str(), &snap) != 0) {
+        return false;
+    }
+    if (stat(textPath.c_str(), &text) != 0) {
+        return true;
+    }
+    if (snap.st_mtim.tv_sec != text.st_mtim.tv_sec) {
+        return snap.st_mtim.tv_sec > text.st_mtim.tv_sec;
+    }
+    return snap.st_mtim.tv_nsec >= text.st_mtim.tv_nsec;
+}
+
+} // namespace snapshot
+
+#endif // GRAPH_SNAPSHOT_H
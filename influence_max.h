@@ -0,0 +1,268 @@
+#ifndef INFLUENCE_MAX_H
+#define INFLUENCE_MAX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "counter_rng.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Influence maximization under independent cascade with IMM (Tang, Shi and
+// Xiao, 2015): sample reverse-reachable (RR) sets from random audience roots,
+// then greedily pick the k vertices covering the most sets. With enough sets
+// the picked seeds reach at least (1 - 1/e - epsilon) of the optimum with
+// probability 1 - 1/n^ell.
+namespace influence {
+
+struct Options {
+    size_t k = 1;
+    double epsilon = 0.5;
+    double ell = 1;
+    uint64_t seed = 1;
+    // Cap on RR-set storage (sets plus the inverted index used by the greedy
+    // pass). Hitting it stops sampling early and clears Result::exact.
+    size_t memoryBytes = size_t(256) << 20;
+};
+
+struct Result {
+    std::vector<uint32_t> seeds; // dense vertices in greedy order
+    double spread = 0;           // estimated audience members reached
+    size_t rrSets = 0;
+    bool exact = true;           // false if the memory cap cut sampling short
+};
+
+// RR sets stored back to back: set i is members[offsets[i] .. offsets[i + 1]).
+class RRCollection {
+public:
+    size_t size() const { return offsets.size() - 1; }
+
+    // Sets plus an equally large inverted index, plus both offset arrays.
+    size_t bytes(size_t vertexCount) const {
+        return members.size() * 2 * sizeof(uint32_t) + (offsets.size() + vertexCount + 1) * sizeof(uint64_t);
+    }
+
+    // Appends sets [size(), size() + count). Set i draws from CounterRng
+    // stream i, so the collection does not depend on the thread count.
+    //
+    // Rows whose weights are all equal (uniformRow[v] >= 0, e.g. weighted
+    // cascade) are sampled with geometric skips as in SUBSIM: the cost is one
+    // draw per fired edge instead of one per edge.
+    void generate(const CsrGraph& graph, const std::vector<float>& weights, const std::vector<float>& uniformRow,
+                  const std::vector<uint32_t>& roots, size_t count, uint64_t seed) {
+        size_t first = size();
+        size_t n = graph.rowCount();
+        std::vector<std::vector<uint64_t>> localOffsets(parallel::blockCount(count, 64));
+        std::vector<std::vector<uint32_t>> localMembers(localOffsets.size());
+        if (visited.size() < localOffsets.size()) {
+            visited.resize(localOffsets.size());
+        }
+        parallel::forBlocks(count, [&](size_t begin, size_t end, unsigned worker) {
+            Visited& seen = visited[worker];
+            if (seen.stamp.size() != n) {
+                seen.stamp.assign(n, 0);
+                seen.mark = 0;
+            }
+            std::vector<uint32_t>& stamp = seen.stamp;
+            auto& sets = localMembers[worker];
+            auto& ends = localOffsets[worker];
+            for (size_t i = begin; i < end; ++i) {
+                if (seen.mark == UINT32_MAX) {
+                    std::fill(stamp.begin(), stamp.end(), 0);
+                    seen.mark = 0;
+                }
+                uint32_t mark = ++seen.mark;
+                CounterRng rng(seed, first + i);
+                uint32_t root = roots[rng.below(roots.size())];
+                size_t head = sets.size();
+                sets.push_back(root);
+                stamp[root] = mark;
+                // Reverse BFS: u joins when the edge u -> v fires; weights
+                // are incoming, so row v's entry for u is p(u -> v).
+                auto visit = [&](uint32_t u) {
+                    if (stamp[u] != mark) {
+                        stamp[u] = mark;
+                        sets.push_back(u);
+                    }
+                };
+                while (head < sets.size()) {
+                    uint32_t v = sets[head++];
+                    uint64_t rowFirst = graph.rowOffsets()[v];
+                    uint64_t rowLast = graph.rowOffsets()[v + 1];
+                    float p = uniformRow[v];
+                    if (p < 0) {
+                        for (uint64_t e = rowFirst; e < rowLast; ++e) {
+                            if (rng.uniform() < weights[e]) {
+                                visit(graph.rowTargets()[e]);
+                            }
+                        }
+                    } else if (p >= 1) {
+                        for (uint64_t e = rowFirst; e < rowLast; ++e) {
+                            visit(graph.rowTargets()[e]);
+                        }
+                    } else if (p > 0) {
+                        double logMiss = std::log1p(-static_cast<double>(p));
+                        for (uint64_t e = rowFirst;; ++e) {
+                            e += static_cast<uint64_t>(std::log(1 - rng.uniform()) / logMiss);
+                            if (e >= rowLast) {
+                                break;
+                            }
+                            visit(graph.rowTargets()[e]);
+                        }
+                    }
+                }
+                ends.push_back(sets.size());
+            }
+        }, 64);
+        for (size_t w = 0; w < localMembers.size(); ++w) {
+            uint64_t base = members.size();
+            members.insert(members.end(), localMembers[w].begin(), localMembers[w].end());
+            for (uint64_t end : localOffsets[w]) {
+                offsets.push_back(base + end);
+            }
+        }
+    }
+
+    // Greedy max coverage: repeatedly takes the vertex in the most uncovered
+    // sets. Returns the seeds and how many sets they cover.
+    std::pair<std::vector<uint32_t>, size_t> select(size_t k, size_t vertexCount) const {
+        std::vector<uint64_t> start(vertexCount + 1, 0);
+        for (uint32_t v : members) {
+            start[v + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            start[v + 1] += start[v];
+        }
+        std::vector<uint32_t> setsOf(members.size());
+        std::vector<uint64_t> fill(start.begin(), start.end() - 1);
+        for (size_t s = 0; s < size(); ++s) {
+            for (uint64_t i = offsets[s]; i < offsets[s + 1]; ++i) {
+                setsOf[fill[members[i]]++] = static_cast<uint32_t>(s);
+            }
+        }
+
+        std::vector<uint64_t> gain(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            gain[v] = start[v + 1] - start[v];
+        }
+        std::vector<uint8_t> covered(size(), 0);
+        std::vector<uint32_t> seeds;
+        size_t coveredSets = 0;
+        for (size_t pick = 0; pick < k; ++pick) {
+            auto best = std::max_element(gain.begin(), gain.end());
+            if (best == gain.end() || *best == 0) {
+                break;
+            }
+            uint32_t v = static_cast<uint32_t>(best - gain.begin());
+            seeds.push_back(v);
+            for (uint64_t i = start[v]; i < start[v + 1]; ++i) {
+                uint32_t s = setsOf[i];
+                if (covered[s]) {
+                    continue;
+                }
+                covered[s] = 1;
+                ++coveredSets;
+                for (uint64_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+                    gain[members[j]]--;
+                }
+            }
+        }
+        return {seeds, coveredSets};
+    }
+
+private:
+    // One visited-stamp array per worker, kept across generate calls: vertex
+    // u is in the set being sampled iff stamp[u] == mark, and mark only grows,
+    // so a new set costs no clearing until the counter wraps.
+    struct Visited {
+        std::vector<uint32_t> stamp;
+        uint32_t mark = 0;
+    };
+
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint32_t> members;
+    std::vector<Visited> visited;
+};
+
+inline double logChoose(double n, double k) { return std::lgamma(n + 1) - std::lgamma(k + 1) - std::lgamma(n - k + 1); }
+
+// Seeds among all vertices of `graph` maximizing the expected number of
+// `roots` (the audience) reached. weights[e] for row v, target u is the
+// probability of the edge u -> v.
+inline Result maximize(const CsrGraph& graph, const std::vector<float>& weights, const std::vector<uint32_t>& roots,
+                       const Options& options) {
+    Result result;
+    double n = static_cast<double>(graph.rowCount());
+    double audience = static_cast<double>(roots.size());
+    if (roots.empty() || options.k == 0) {
+        return result;
+    }
+    double k = std::min<double>(static_cast<double>(options.k), n);
+
+    // Parameters from the paper, with n the candidate count for the union
+    // bound and the audience size scaling the spread.
+    double logN = std::log(std::max(n, 2.0));
+    double ell = options.ell * (1 + std::log(2.0) / logN);
+    double epsPrime = std::sqrt(2.0) * options.epsilon;
+    double lambdaPrime = (2 + 2.0 / 3 * epsPrime) *
+                         (logChoose(n, k) + ell * logN + std::log(std::max(std::log2(audience), 1.0))) * audience /
+                         (epsPrime * epsPrime);
+    double alpha = std::sqrt(ell * logN + std::log(2.0));
+    double beta = std::sqrt((1 - 1 / M_E) * (logChoose(n, k) + ell * logN + std::log(2.0)));
+    double lambdaStar = 2 * audience * std::pow((1 - 1 / M_E) * alpha + beta, 2) / (options.epsilon * options.epsilon);
+
+    RRCollection sets;
+    size_t vertexCount = graph.rowCount();
+    std::vector<float> uniformRow(vertexCount, -1);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        uint64_t first = graph.rowOffsets()[v];
+        uint64_t last = graph.rowOffsets()[v + 1];
+        if (first == last || std::all_of(weights.begin() + first, weights.begin() + last,
+                                         [&](float w) { return w == weights[first]; })) {
+            uniformRow[v] = first == last ? 0 : weights[first];
+        }
+    }
+    auto grow = [&](double target) {
+        const size_t batch = 4096;
+        while (sets.size() < target) {
+            if (sets.bytes(vertexCount) > options.memoryBytes) {
+                result.exact = false;
+                return;
+            }
+            size_t count = std::min<size_t>(batch, static_cast<size_t>(std::ceil(target)) - sets.size());
+            sets.generate(graph, weights, uniformRow, roots, count, options.seed);
+        }
+    };
+
+    // Sampling phase: halve the guess x until the estimate confirms a lower
+    // bound on the optimum.
+    double lowerBound = 1;
+    for (int i = 1; i < std::log2(audience); ++i) {
+        double x = audience / std::pow(2.0, i);
+        grow(lambdaPrime / x);
+        if (sets.size() == 0) {
+            break;
+        }
+        auto picked = sets.select(static_cast<size_t>(k), vertexCount);
+        double estimate = audience * picked.second / sets.size();
+        if (estimate >= (1 + epsPrime) * x || !result.exact) {
+            lowerBound = estimate / (1 + epsPrime);
+            break;
+        }
+    }
+
+    grow(lambdaStar / std::max(lowerBound, 1.0));
+    auto picked = sets.select(static_cast<size_t>(k), vertexCount);
+    result.seeds = picked.first;
+    result.rrSets = sets.size();
+    result.spread = sets.size() ? audience * picked.second / sets.size() : 0;
+    return result;
+}
+
+} // namespace influence
+
+#endif // INFLUENCE_MAX_H
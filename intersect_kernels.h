@@ -0,0 +1,119 @@
+#ifndef INTERSECT_KERNELS_H
+#define INTERSECT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INTERSECT_KERNELS_X86 1
+#endif
+
+// Intersection of two strictly ascending uint32 lists: the common values are
+// written to out (room for min(na, nb)) in order and their count returned.
+// SIMD versions compare a block of a against every rotation of a block of b
+// and advance whichever block ends lower; as in bitset_kernels.h the variant
+// is chosen for the running CPU on first use.
+namespace kernels {
+
+using IntersectOp = size_t (*)(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out);
+
+namespace scalar {
+
+inline size_t intersect(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out) {
+    size_t i = 0, j = 0, count = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            out[count++] = a[i];
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+} // namespace scalar
+
+#ifdef INTERSECT_KERNELS_X86
+
+namespace avx2 {
+
+__attribute__((target("avx2"))) inline size_t intersect(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                                                        uint32_t* out) {
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    size_t i = 0, j = 0, count = 0;
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i hits = _mm256_cmpeq_epi32(x, y);
+        for (int r = 1; r < 8; ++r) {
+            y = _mm256_permutevar8x32_epi32(y, rotate);
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi32(x, y));
+        }
+        for (unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(hits))); mask;
+             mask &= mask - 1) {
+            out[count++] = a[i + __builtin_ctz(mask)];
+        }
+        uint32_t lastA = a[i + 7], lastB = b[j + 7];
+        i += lastA <= lastB ? 8 : 0;
+        j += lastB <= lastA ? 8 : 0;
+    }
+    return count + scalar::intersect(a + i, na - i, b + j, nb - j, out + count);
+}
+
+} // namespace avx2
+
+namespace avx512 {
+
+// The zero-masked permute sidesteps the -Wuninitialized that GCC 12 reports
+// for the unmasked one.
+__attribute__((target("avx512f"))) inline size_t intersect(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                                                           uint32_t* out) {
+    const __m512i rotate = _mm512_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0);
+    size_t i = 0, j = 0, count = 0;
+    while (i + 16 <= na && j + 16 <= nb) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + j);
+        __mmask16 hits = _mm512_cmpeq_epi32_mask(x, y);
+        for (int r = 1; r < 16; ++r) {
+            y = _mm512_maskz_permutexvar_epi32(0xFFFF, rotate, y);
+            hits |= _mm512_cmpeq_epi32_mask(x, y);
+        }
+        _mm512_mask_compressstoreu_epi32(out + count, hits, x);
+        count += static_cast<size_t>(__builtin_popcount(hits));
+        uint32_t lastA = a[i + 15], lastB = b[j + 15];
+        i += lastA <= lastB ? 16 : 0;
+        j += lastB <= lastA ? 16 : 0;
+    }
+    return count + scalar::intersect(a + i, na - i, b + j, nb - j, out + count);
+}
+
+} // namespace avx512
+
+#endif // INTERSECT_KERNELS_X86
+
+inline IntersectOp selectIntersect() {
+#ifdef INTERSECT_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return avx512::intersect;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2::intersect;
+    }
+#endif
+    return scalar::intersect;
+}
+
+inline IntersectOp intersect() {
+    static const IntersectOp selected = selectIntersect();
+    return selected;
+}
+
+} // namespace kernels
+
+#endif // INTERSECT_KERNELS_H
@@ -0,0 +1,188 @@
+#ifndef KCORE_H
+#define KCORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "parallel.h"
+
+namespace centrality {
+
+struct CoreResult {
+    std::vector<uint32_t> coreness;  // per dense vertex
+    uint32_t maxCore = 0;
+    std::vector<uint32_t> innermost; // vertices with coreness == maxCore, ascending
+};
+
+namespace detail {
+
+// Degree without self-loops, which would otherwise keep a vertex in cores it
+// cannot support on its own.
+inline uint32_t simpleDegree(const CsrGraph& graph, uint32_t v) {
+    uint32_t degree = 0;
+    for (const uint32_t* p = graph.rowBegin(v); p != graph.rowEnd(v); ++p) {
+        degree += (*p != v);
+    }
+    return degree;
+}
+
+inline void collectInnermost(CoreResult& result) {
+    for (uint32_t core : result.coreness) {
+        result.maxCore = std::max(result.maxCore, core);
+    }
+    for (uint32_t v = 0; v < result.coreness.size(); ++v) {
+        if (result.coreness[v] == result.maxCore) {
+            result.innermost.push_back(v);
+        }
+    }
+}
+
+} // namespace detail
+
+// Batagelj-Zaversnik: vertices kept in degree order with bucket starts, so
+// removing the minimum and lowering a neighbor's degree are O(1) swaps and
+// the whole decomposition is O(n + m).
+inline CoreResult coreDecomposition(const CsrGraph& graph) {
+    CoreResult result;
+    size_t n = graph.rowCount();
+    std::vector<uint32_t> degree(n);
+    uint32_t maxDegree = 0;
+    for (uint32_t v = 0; v < n; ++v) {
+        degree[v] = detail::simpleDegree(graph, v);
+        maxDegree = std::max(maxDegree, degree[v]);
+    }
+
+    std::vector<uint32_t> bucketStart(maxDegree + 2, 0);
+    for (uint32_t d : degree) {
+        bucketStart[d + 1]++;
+    }
+    for (size_t d = 0; d <= maxDegree; ++d) {
+        bucketStart[d + 1] += bucketStart[d];
+    }
+    std::vector<uint32_t> order(n), position(n);
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (uint32_t v = 0; v < n; ++v) {
+        position[v] = fill[degree[v]]++;
+        order[position[v]] = v;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t v = order[i];
+        for (const uint32_t* p = graph.rowBegin(v); p != graph.rowEnd(v); ++p) {
+            uint32_t u = *p;
+            if (degree[u] <= degree[v]) {
+                continue;
+            }
+            // Move u to the front of its bucket, then shrink the bucket.
+            uint32_t du = degree[u];
+            uint32_t w = order[bucketStart[du]];
+            if (u != w) {
+                std::swap(order[position[u]], order[position[w]]);
+                std::swap(position[u], position[w]);
+            }
+            bucketStart[du]++;
+            degree[u]--;
+        }
+    }
+    result.coreness = std::move(degree);
+    detail::collectInnermost(result);
+    return result;
+}
+
+// Level-synchronous peeling (as in PKC): at level k every remaining vertex of
+// degree <= k is removed in parallel, and neighbors whose degree drops to k
+// join the next sub-round. Degrees are updated with atomics; a decrement that
+// would go below k is undone, since that vertex is already being peeled.
+inline CoreResult coreDecompositionParallel(const CsrGraph& graph) {
+    CoreResult result;
+    size_t n = graph.rowCount();
+    std::vector<int64_t> degree(n);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            degree[v] = detail::simpleDegree(graph, static_cast<uint32_t>(v));
+        }
+    });
+    result.coreness.assign(n, 0);
+    std::vector<uint8_t> removed(n, 0);
+
+    size_t remaining = n;
+    unsigned scanWorkers = parallel::blockCount(n);
+    std::vector<std::vector<uint32_t>> found(scanWorkers);
+    std::vector<int64_t> minima(scanWorkers);
+    while (remaining > 0) {
+        // The next level is the smallest remaining degree; skipping empty
+        // levels keeps the scan count at the number of distinct cores.
+        parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned worker) {
+            int64_t low = INT64_MAX;
+            for (size_t v = begin; v < end; ++v) {
+                if (!removed[v]) {
+                    low = std::min(low, degree[v]);
+                }
+            }
+            minima[worker] = low;
+        });
+        int64_t k = *std::min_element(minima.begin(), minima.end());
+
+        parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned worker) {
+            found[worker].clear();
+            for (size_t v = begin; v < end; ++v) {
+                if (!removed[v] && degree[v] <= k) {
+                    found[worker].push_back(static_cast<uint32_t>(v));
+                }
+            }
+        });
+        std::vector<uint32_t> frontier;
+        for (const auto& part : found) {
+            frontier.insert(frontier.end(), part.begin(), part.end());
+        }
+
+        while (!frontier.empty()) {
+            for (uint32_t v : frontier) {
+                removed[v] = 1;
+                result.coreness[v] = static_cast<uint32_t>(k);
+            }
+            remaining -= frontier.size();
+            std::vector<std::vector<uint32_t>> next(parallel::blockCount(frontier.size(), 256));
+            parallel::forBlocks(frontier.size(), [&](size_t begin, size_t end, unsigned worker) {
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t v = frontier[i];
+                    for (const uint32_t* p = graph.rowBegin(v); p != graph.rowEnd(v); ++p) {
+                        uint32_t u = *p;
+                        if (u == v || __atomic_load_n(&degree[u], __ATOMIC_RELAXED) <= k) {
+                            continue;
+                        }
+                        int64_t after = __atomic_sub_fetch(&degree[u], 1, __ATOMIC_RELAXED);
+                        if (after == k) {
+                            next[worker].push_back(u);
+                        } else if (after < k) {
+                            __atomic_add_fetch(&degree[u], 1, __ATOMIC_RELAXED);
+                        }
+                    }
+                }
+            }, 256);
+            frontier.clear();
+            for (const auto& part : next) {
+                frontier.insert(frontier.end(), part.begin(), part.end());
+            }
+        }
+    }
+    detail::collectInnermost(result);
+    return result;
+}
+
+// Serial bucket peeling for small graphs, level-parallel peeling once there
+// is enough work to spread over threads.
+inline CoreResult coreDecompositionAuto(const CsrGraph& graph) {
+    constexpr size_t kParallelEdges = size_t(1) << 22;
+    if (parallel::threadCount() > 1 && graph.rowTargets().size() >= kParallelEdges) {
+        return coreDecompositionParallel(graph);
+    }
+    return coreDecomposition(graph);
+}
+
+} // namespace centrality
+
+#endif // KCORE_H
@@ -0,0 +1,252 @@
+#ifndef LOOKALIKE_H
+#define LOOKALIKE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "counter_rng.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Lookalike audiences by MinHash and LSH banding. Each vertex is the set of
+// its characteristics plus its closed neighborhood (friends and itself), so
+// two users look alike when they share interests and friends. A signature
+// of `hashes` minima estimates the Jaccard similarity of two sets as the
+// fraction of agreeing rows; banding puts vertices whose rows agree on a
+// whole band into the same bucket, so a query only scores vertices that
+// share a bucket with a seed instead of every vertex.
+namespace lookalike {
+
+struct Options {
+    unsigned hashes = 96; // signature rows; rounded down to a multiple of bands
+    unsigned bands = 32;  // 32 bands of 3 rows: pairs above ~0.3 Jaccard usually collide
+    uint64_t seed = 1;
+};
+
+// Buckets larger than this are skipped at query time: a bucket that holds a
+// large share of the graph says little about any one seed and would make
+// the query linear.
+constexpr size_t kMaxBucket = 4096;
+
+struct Match {
+    uint32_t vertex;
+    double similarity; // estimated Jaccard similarity to the closest seed
+};
+
+class Index {
+public:
+    // chars(v) gives v's characteristic IDs as a pointer pair; member(v)
+    // says whether v may appear in results. Signatures are computed in
+    // parallel, one vertex per step, then each band is sorted in parallel.
+    template <typename Chars, typename Member>
+    static Index build(const CsrGraph& graph, Chars chars, Member member, const Options& options = {}) {
+        Index index;
+        index.configure(options);
+        const size_t rows = index.rowCount;
+        const size_t n = graph.rowCount();
+        const std::vector<uint64_t>& offsets = graph.rowOffsets();
+        const std::vector<uint32_t>& targets = graph.rowTargets();
+        const uint64_t key = CounterRng::mix(options.seed);
+        index.signatureRows.assign(n * rows, UINT32_MAX);
+
+        parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+            for (size_t v = begin; v < end; ++v) {
+                uint32_t* row = index.signatureRows.data() + v * rows;
+                // Characteristic c is element 2c, vertex u is element 2u + 1.
+                auto run = chars(static_cast<uint32_t>(v));
+                for (const uint32_t* p = run.first; p != run.second; ++p) {
+                    fold(row, rows, key, uint64_t(*p) << 1);
+                }
+                fold(row, rows, key, (uint64_t(v) << 1) | 1);
+                for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                    fold(row, rows, key, (uint64_t(targets[e]) << 1) | 1);
+                }
+            }
+        }, 256);
+        index.buildBands(member);
+        return index;
+    }
+
+    // Rebuilds the band tables over signatures saved from signatures().
+    // Returns an empty index when the sizes do not fit `vertexCount`.
+    template <typename Member>
+    static Index restore(const Options& options, std::vector<uint32_t> signatures, size_t vertexCount, Member member) {
+        Index index;
+        index.configure(options);
+        if (signatures.size() != vertexCount * index.rowCount) {
+            return Index();
+        }
+        index.signatureRows = std::move(signatures);
+        index.buildBands(member);
+        return index;
+    }
+
+    bool empty() const { return signatureRows.empty(); }
+    size_t vertexCount() const { return rowCount ? signatureRows.size() / rowCount : 0; }
+    const Options& options() const { return config; }
+
+    // rows per vertex, vertex-major, for persisting.
+    const std::vector<uint32_t>& signatures() const { return signatureRows; }
+
+    // Estimated Jaccard similarity of two vertices' sets.
+    double similarity(uint32_t a, uint32_t b) const {
+        const uint32_t* x = signatureRows.data() + size_t(a) * rowCount;
+        const uint32_t* y = signatureRows.data() + size_t(b) * rowCount;
+        unsigned same = 0;
+        for (size_t r = 0; r < rowCount; ++r) {
+            same += x[r] == y[r];
+        }
+        return static_cast<double>(same) / rowCount;
+    }
+
+    // The k member vertices most similar to any seed, seeds excluded, by
+    // similarity descending then vertex ascending. Cost is per seed and
+    // band: one binary search plus the bucket's members.
+    std::vector<Match> query(const std::vector<uint32_t>& seeds, size_t k, size_t maxBucket = kMaxBucket) const {
+        std::vector<uint32_t> sortedSeeds;
+        for (uint32_t s : seeds) {
+            if (s < vertexCount()) {
+                sortedSeeds.push_back(s);
+            }
+        }
+        std::sort(sortedSeeds.begin(), sortedSeeds.end());
+        sortedSeeds.erase(std::unique(sortedSeeds.begin(), sortedSeeds.end()), sortedSeeds.end());
+
+        std::vector<std::unordered_map<uint32_t, double>> best(parallel::blockCount(sortedSeeds.size(), 16));
+        parallel::forBlocks(sortedSeeds.size(), [&](size_t begin, size_t end, unsigned worker) {
+            std::vector<uint32_t> candidates;
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t s = sortedSeeds[i];
+                candidates.clear();
+                for (size_t b = 0; b < tables.size(); ++b) {
+                    const Band& band = tables[b];
+                    auto range = std::equal_range(band.keys.begin(), band.keys.end(), bandKey(s, b));
+                    size_t size = static_cast<size_t>(range.second - range.first);
+                    if (size > maxBucket) {
+                        continue;
+                    }
+                    size_t first = static_cast<size_t>(range.first - band.keys.begin());
+                    candidates.insert(candidates.end(), band.vertices.begin() + first,
+                                      band.vertices.begin() + first + size);
+                }
+                std::sort(candidates.begin(), candidates.end());
+                candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+                for (uint32_t u : candidates) {
+                    if (std::binary_search(sortedSeeds.begin(), sortedSeeds.end(), u)) {
+                        continue;
+                    }
+                    double& score = best[worker][u];
+                    score = std::max(score, similarity(s, u));
+                }
+            }
+        }, 16);
+
+        for (size_t w = 1; w < best.size(); ++w) {
+            for (const auto& entry : best[w]) {
+                double& score = best[0][entry.first];
+                score = std::max(score, entry.second);
+            }
+        }
+        std::vector<Match> matches;
+        if (!best.empty()) {
+            for (const auto& entry : best[0]) {
+                matches.push_back({entry.first, entry.second});
+            }
+        }
+        auto better = [](const Match& a, const Match& b) {
+            return a.similarity > b.similarity || (a.similarity == b.similarity && a.vertex < b.vertex);
+        };
+        size_t shown = std::min(k, matches.size());
+        std::partial_sort(matches.begin(), matches.begin() + shown, matches.end(), better);
+        matches.resize(shown);
+        return matches;
+    }
+
+private:
+    // One band: its bucket key per member vertex, sorted by key.
+    struct Band {
+        std::vector<uint32_t> keys;
+        std::vector<uint32_t> vertices;
+    };
+
+    void configure(const Options& options) {
+        config = options;
+        config.bands = std::max(1u, options.bands);
+        config.hashes = std::max(config.bands, options.hashes / config.bands * config.bands);
+        rowCount = config.hashes;
+        bandRows = config.hashes / config.bands;
+    }
+
+    // Row r's hash of x is a 32-bit finalizer over h1 + r * h2 (two halves
+    // of one 64-bit hash): one 64-bit mix per element, and a loop over rows
+    // of 32-bit multiplies, shifts and a min that the compiler can vectorize.
+    // The finalizer matters; the bare linear rows are correlated enough to
+    // inflate the estimate's error by about 40%.
+    static void fold(uint32_t* row, size_t rows, uint64_t key, uint64_t element) {
+        uint64_t hash = CounterRng::mix(element * 0x9E3779B97F4A7C15ULL ^ key);
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        for (size_t r = 0; r < rows; ++r) {
+            uint32_t h = h1 + static_cast<uint32_t>(r) * h2;
+            h ^= h >> 16;
+            h *= 0x85EBCA6BU;
+            h ^= h >> 13;
+            h *= 0xC2B2AE35U;
+            h ^= h >> 16;
+            row[r] = h < row[r] ? h : row[r];
+        }
+    }
+
+    // Colliding keys from different bands cost a wasted candidate, not a
+    // wrong answer: every candidate is rescored from the full signatures.
+    uint32_t bandKey(uint32_t v, size_t band) const {
+        const uint32_t* rows = signatureRows.data() + size_t(v) * rowCount + band * bandRows;
+        uint64_t h = band;
+        for (size_t r = 0; r < bandRows; ++r) {
+            h = CounterRng::mix(h ^ rows[r]);
+        }
+        return static_cast<uint32_t>(h);
+    }
+
+    template <typename Member>
+    void buildBands(Member member) {
+        size_t n = vertexCount();
+        std::vector<uint32_t> members;
+        for (uint32_t v = 0; v < n; ++v) {
+            if (member(v)) {
+                members.push_back(v);
+            }
+        }
+        tables.assign(config.bands, Band());
+        parallel::forBlocks(tables.size(), [&](size_t begin, size_t end, unsigned) {
+            std::vector<std::pair<uint32_t, uint32_t>> entries(members.size());
+            for (size_t b = begin; b < end; ++b) {
+                for (size_t i = 0; i < members.size(); ++i) {
+                    entries[i] = {bandKey(members[i], b), members[i]};
+                }
+                std::sort(entries.begin(), entries.end());
+                Band& band = tables[b];
+                band.keys.resize(entries.size());
+                band.vertices.resize(entries.size());
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    band.keys[i] = entries[i].first;
+                    band.vertices[i] = entries[i].second;
+                }
+            }
+        }, 1);
+    }
+
+    Options config;
+    size_t rowCount = 0;
+    size_t bandRows = 0;
+    std::vector<uint32_t> signatureRows; // signatureRows[v * rowCount + r]
+    std::vector<Band> tables;
+};
+
+} // namespace lookalike
+
+#endif // LOOKALIKE_H
@@ -0,0 +1,155 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file. The loaders tokenize straight out
+// of the mapping, so nothing is copied until a value is actually kept.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path) { open(path); }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : fd(other.fd), base(other.base), length(other.length), mtime(other.mtime) {
+        other.fd = -1;
+        other.base = nullptr;
+        other.length = 0;
+    }
+
+    bool open(const std::string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(st.st_size);
+        mtime = st.st_mtime;
+        if (length == 0) {
+            // mmap rejects zero-length mappings; an empty file is still a valid file.
+            return true;
+        }
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base = static_cast<const char*>(mapped);
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    void close() {
+        if (base) {
+            munmap(const_cast<char*>(base), length);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        length = 0;
+    }
+
+    bool is_open() const { return fd >= 0; }
+    const char* data() const { return base; }
+    const char* end() const { return base + length; }
+    size_t size() const { return length; }
+    time_t modifiedTime() const { return mtime; }
+    std::string_view view() const { return std::string_view(base, length); }
+
+private:
+    int fd = -1;
+    const char* base = nullptr;
+    size_t length = 0;
+    time_t mtime = 0;
+};
+
+// Hand-written scanners over [p, end). Each one advances p past what it consumed
+// and never reads beyond end, so they work directly on a mapping with no NUL.
+namespace scan {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline void skipSpaces(const char*& p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+}
+
+// Returns the line starting at p (without the newline or a trailing '\r') and
+// moves p to the start of the next line.
+inline std::string_view nextLine(const char*& p, const char* end) {
+    const char* start = p;
+    const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    const char* stop = nl ? nl : end;
+    p = nl ? nl + 1 : end;
+    if (stop > start && stop[-1] == '\r') {
+        --stop;
+    }
+    return std::string_view(start, static_cast<size_t>(stop - start));
+}
+
+// Same contract as `istream >> int`: optional leading blanks and sign, at least
+// one digit, fails on overflow. Parsing stops at the first non-digit.
+inline bool parseInt(const char*& p, const char* end, int& out) {
+    const char* q = p;
+    skipSpaces(q, end);
+    bool negative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+        negative = (*q == '-');
+        ++q;
+    }
+    if (q == end || static_cast<unsigned>(*q - '0') > 9) {
+        return false;
+    }
+    int64_t value = 0;
+    const int64_t limit = negative ? int64_t(INT32_MAX) + 1 : int64_t(INT32_MAX);
+    while (q < end && static_cast<unsigned>(*q - '0') <= 9) {
+        value = value * 10 + (*q - '0');
+        if (value > limit) {
+            return false;
+        }
+        ++q;
+    }
+    out = static_cast<int>(negative ? -value : value);
+    p = q;
+    return true;
+}
+
+// Next whitespace-delimited token, or an empty view at end of input.
+inline std::string_view nextToken(const char*& p, const char* end) {
+    skipSpaces(p, end);
+    const char* start = p;
+    while (p < end && !isSpace(*p) && *p != '\n') {
+        ++p;
+    }
+    return std::string_view(start, static_cast<size_t>(p - start));
+}
+
+} // namespace scan
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,177 @@
+#ifndef NEIGHBOR_HISTOGRAM_H
+#define NEIGHBOR_HISTOGRAM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.h"
+#include "parallel.h"
+
+// "Your friends like X": for every vertex, the characteristics most common
+// among its neighbors, from one parallel pass over the adjacency.
+namespace neighborhood {
+
+// Top characteristics of each vertex's neighbors: vertex v's entries are
+// [offsets[v], offsets[v + 1]), by count descending, then ID ascending.
+struct Profile {
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint32_t> characteristics;
+    std::vector<uint32_t> counts;
+
+    size_t vertexCount() const { return offsets.size() - 1; }
+
+    std::vector<std::pair<uint32_t, uint32_t>> top(uint32_t v) const {
+        std::vector<std::pair<uint32_t, uint32_t>> result;
+        if (v < vertexCount()) {
+            for (uint64_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+                result.push_back({characteristics[i], counts[i]});
+            }
+        }
+        return result;
+    }
+};
+
+namespace detail {
+
+// Counters for one range of characteristic IDs. Only touched slots are
+// reset, so a vertex costs what its neighbors hold, not the range width.
+struct Counters {
+    std::vector<uint32_t> count;
+    std::vector<uint32_t> touched;
+
+    void add(uint32_t slot) {
+        if (count[slot]++ == 0) {
+            touched.push_back(slot);
+        }
+    }
+
+    // Merges this range's best m (IDs are base + slot) into `best`, which
+    // stays sorted and at most m long, then clears.
+    void drain(uint32_t base, size_t m, std::vector<std::pair<uint32_t, uint32_t>>& best) {
+        auto better = [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+            return a.second > b.second || (a.second == b.second && a.first < b.first);
+        };
+        size_t before = best.size();
+        for (uint32_t slot : touched) {
+            best.push_back({base + slot, count[slot]});
+            count[slot] = 0;
+        }
+        touched.clear();
+        size_t fresh = std::min(m, best.size() - before);
+        std::partial_sort(best.begin() + before, best.begin() + before + fresh, best.end(), better);
+        best.resize(before + fresh);
+        std::inplace_merge(best.begin(), best.begin() + before, best.end(), better);
+        if (best.size() > m) {
+            best.resize(m);
+        }
+    }
+};
+
+} // namespace detail
+
+// chars(v) gives v's sorted characteristic IDs as a pointer pair; IDs are
+// below characteristicCount. Self-loops are ignored.
+//
+// When the counters for every ID fit in kBlockIds slots (256 KiB), each
+// vertex counts straight into them. Past that, a random increment per
+// neighbor characteristic would miss cache, so each worker takes
+// kTileVertices vertices at a time, partitions their neighbor
+// characteristics by ID block, and counts one block at a time into a
+// cache-resident array; per-block winners are merged per vertex.
+template <typename Chars>
+Profile topCharacteristics(const CsrGraph& graph, size_t characteristicCount, Chars chars, size_t m) {
+    constexpr size_t kBlockIds = size_t(1) << 16;
+    constexpr size_t kTileVertices = 256;
+
+    size_t n = graph.rowCount();
+    const std::vector<uint64_t>& offsets = graph.rowOffsets();
+    const std::vector<uint32_t>& targets = graph.rowTargets();
+    size_t blocks = std::max<size_t>(1, (characteristicCount + kBlockIds - 1) / kBlockIds);
+    size_t slots = std::min(kBlockIds, std::max<size_t>(1, characteristicCount));
+
+    unsigned workers = parallel::blockCount(n, 1024);
+    std::vector<Profile> parts(workers);
+    std::vector<std::vector<uint64_t>> lengths(workers);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned worker) {
+        detail::Counters counters;
+        counters.count.assign(slots, 0);
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> best(kTileVertices);
+        // Per block: (vertex within the tile, slot), grouped by vertex.
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> staged(blocks);
+        Profile& part = parts[worker];
+
+        for (size_t tile = begin; tile < end; tile += kTileVertices) {
+            size_t tileEnd = std::min(end, tile + kTileVertices);
+            if (blocks == 1) {
+                for (size_t v = tile; v < tileEnd; ++v) {
+                    for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                        uint32_t u = targets[e];
+                        if (u == v) {
+                            continue;
+                        }
+                        auto run = chars(u);
+                        for (const uint32_t* p = run.first; p != run.second; ++p) {
+                            counters.add(*p);
+                        }
+                    }
+                    counters.drain(0, m, best[v - tile]);
+                }
+            } else {
+                for (size_t v = tile; v < tileEnd; ++v) {
+                    uint32_t local = static_cast<uint32_t>(v - tile);
+                    for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                        uint32_t u = targets[e];
+                        if (u == v) {
+                            continue;
+                        }
+                        auto run = chars(u);
+                        for (const uint32_t* p = run.first; p != run.second; ++p) {
+                            staged[*p / kBlockIds].push_back({local, static_cast<uint32_t>(*p % kBlockIds)});
+                        }
+                    }
+                }
+                for (size_t b = 0; b < blocks; ++b) {
+                    auto& entries = staged[b];
+                    for (size_t i = 0; i < entries.size();) {
+                        uint32_t local = entries[i].first;
+                        for (; i < entries.size() && entries[i].first == local; ++i) {
+                            counters.add(entries[i].second);
+                        }
+                        counters.drain(static_cast<uint32_t>(b * kBlockIds), m, best[local]);
+                    }
+                    entries.clear();
+                }
+            }
+            for (size_t v = tile; v < tileEnd; ++v) {
+                auto& row = best[v - tile];
+                for (const auto& entry : row) {
+                    part.characteristics.push_back(entry.first);
+                    part.counts.push_back(entry.second);
+                }
+                lengths[worker].push_back(row.size());
+                row.clear();
+            }
+        }
+    }, 1024);
+
+    // Blocks are contiguous and in worker order, so the parts concatenate.
+    Profile profile;
+    profile.offsets.reserve(n + 1);
+    for (unsigned w = 0; w < workers; ++w) {
+        for (uint64_t length : lengths[w]) {
+            profile.offsets.push_back(profile.offsets.back() + length);
+        }
+        profile.characteristics.insert(profile.characteristics.end(), parts[w].characteristics.begin(),
+                                       parts[w].characteristics.end());
+        profile.counts.insert(profile.counts.end(), parts[w].counts.begin(), parts[w].counts.end());
+        parts[w] = Profile();
+    }
+    return profile;
+}
+
+} // namespace neighborhood
+
+#endif // NEIGHBOR_HISTOGRAM_H
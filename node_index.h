@@ -0,0 +1,66 @@
+#ifndef NODE_INDEX_H
+#define NODE_INDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Bidirectional mapping between the arbitrary int IDs used in nodes.txt and
+// dense 0..N-1 indexes. Dense indexes are handed out in first-seen order and
+// every internal array is indexed by them; external IDs only appear at the
+// API and GUI boundary.
+class NodeIndex {
+public:
+    static constexpr uint32_t kMissing = UINT32_MAX;
+
+    uint32_t intern(int externalId) {
+        auto inserted = index.emplace(externalId, static_cast<uint32_t>(external.size()));
+        if (inserted.second) {
+            external.push_back(externalId);
+        }
+        return inserted.first->second;
+    }
+
+    uint32_t find(int externalId) const {
+        auto it = index.find(externalId);
+        return it == index.end() ? kMissing : it->second;
+    }
+
+    int externalId(uint32_t dense) const { return external[dense]; }
+
+    // External IDs in dense order.
+    const std::vector<int>& externalIds() const { return external; }
+
+    size_t size() const { return external.size(); }
+
+    void reserve(size_t n) {
+        external.reserve(n);
+        index.reserve(n);
+    }
+
+    void clear() {
+        external.clear();
+        index.clear();
+    }
+
+    // Rebuilds the reverse map from a dense-ordered column (snapshot loads).
+    // Returns false if the column repeats an ID.
+    bool assign(std::vector<int> externalIds) {
+        clear();
+        external = std::move(externalIds);
+        index.reserve(external.size());
+        for (uint32_t dense = 0; dense < external.size(); ++dense) {
+            if (!index.emplace(external[dense], dense).second) {
+                clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    std::vector<int> external;
+    std::unordered_map<int, uint32_t> index;
+};
+
+#endif // NODE_INDEX_H
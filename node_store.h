@@ -0,0 +1,141 @@
+#ifndef NODE_STORE_H
+#define NODE_STORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Read-only handle to one node: its external ID, dense index and sorted
+// characteristic IDs. Cheap to copy; valid until the next addNode.
+class NodeView {
+public:
+    NodeView(int id, uint32_t index, const uint32_t* first, const uint32_t* last)
+        : externalId(id), denseIndex(index), first(first), last(last) {}
+
+    int id() const { return externalId; }
+    uint32_t index() const { return denseIndex; }
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+
+    bool has(uint32_t characteristic) const { return std::binary_search(first, last, characteristic); }
+
+    // Both sides sorted, so this is a single merge pass.
+    bool hasAll(const std::vector<uint32_t>& sortedTargets) const {
+        return std::includes(first, last, sortedTargets.begin(), sortedTargets.end());
+    }
+
+private:
+    int externalId;
+    uint32_t denseIndex;
+    const uint32_t* first;
+    const uint32_t* last;
+};
+
+// Columnar node storage indexed by dense vertex index. Each vertex has a
+// declared flag (it had a node line) and a run [charStart, charStart +
+// charCount) in one shared pool of sorted characteristic IDs. Redefining a
+// node appends a new run; the pool is compacted once the dead runs dominate.
+class NodeStore {
+public:
+    size_t size() const { return declared.size(); }
+
+    size_t declaredCount() const { return liveNodes; }
+
+    void resize(size_t n) {
+        declared.resize(n, 0);
+        charStart.resize(n, 0);
+        charCount.resize(n, 0);
+    }
+
+    // `ids` must already be sorted and unique.
+    void set(uint32_t v, const std::vector<uint32_t>& ids) {
+        if (v >= size()) {
+            resize(v + 1);
+        }
+        if (declared[v]) {
+            deadEntries += charCount[v];
+        } else {
+            declared[v] = 1;
+            ++liveNodes;
+        }
+        charStart[v] = static_cast<uint32_t>(pool.size());
+        charCount[v] = static_cast<uint32_t>(ids.size());
+        pool.insert(pool.end(), ids.begin(), ids.end());
+        if (deadEntries > kMinDeadBeforeCompact && deadEntries * 2 > pool.size()) {
+            compact();
+        }
+    }
+
+    bool isDeclared(uint32_t v) const { return declared[v] != 0; }
+
+    const uint32_t* charBegin(uint32_t v) const { return pool.data() + charStart[v]; }
+    const uint32_t* charEnd(uint32_t v) const { return pool.data() + charStart[v] + charCount[v]; }
+
+    bool has(uint32_t v, uint32_t characteristic) const {
+        return std::binary_search(charBegin(v), charEnd(v), characteristic);
+    }
+
+    // Rewrites the pool so runs are contiguous and in vertex order; afterwards
+    // charStart doubles as a CSR offsets column.
+    void compact() {
+        std::vector<uint32_t> packed;
+        packed.reserve(pool.size() - deadEntries);
+        for (size_t v = 0; v < size(); ++v) {
+            uint32_t start = static_cast<uint32_t>(packed.size());
+            packed.insert(packed.end(), charBegin(static_cast<uint32_t>(v)), charEnd(static_cast<uint32_t>(v)));
+            charStart[v] = start;
+        }
+        pool.swap(packed);
+        deadEntries = 0;
+    }
+
+    // Offsets form (size() + 1 entries) for serialization.
+    void exportColumns(std::vector<uint8_t>& flags, std::vector<uint32_t>& offsets, std::vector<uint32_t>& ids) const {
+        flags = declared;
+        offsets.assign(1, 0);
+        ids.clear();
+        ids.reserve(pool.size() - deadEntries);
+        for (size_t v = 0; v < size(); ++v) {
+            ids.insert(ids.end(), charBegin(static_cast<uint32_t>(v)), charEnd(static_cast<uint32_t>(v)));
+            offsets.push_back(static_cast<uint32_t>(ids.size()));
+        }
+    }
+
+    // Inverse of exportColumns; offsets must be non-decreasing.
+    void assign(std::vector<uint8_t> flags, const std::vector<uint32_t>& offsets, std::vector<uint32_t> ids) {
+        declared = std::move(flags);
+        pool = std::move(ids);
+        charStart.assign(offsets.begin(), offsets.end() - 1);
+        charCount.resize(declared.size());
+        liveNodes = 0;
+        for (size_t v = 0; v < declared.size(); ++v) {
+            charCount[v] = offsets[v + 1] - offsets[v];
+            liveNodes += declared[v] ? 1 : 0;
+        }
+        deadEntries = 0;
+    }
+
+    void clear() {
+        declared.clear();
+        charStart.clear();
+        charCount.clear();
+        pool.clear();
+        liveNodes = 0;
+        deadEntries = 0;
+    }
+
+private:
+    static constexpr size_t kMinDeadBeforeCompact = 1 << 16;
+
+    std::vector<uint8_t> declared;
+    std::vector<uint32_t> charStart;
+    std::vector<uint32_t> charCount;
+    std::vector<uint32_t> pool;
+    size_t liveNodes = 0;
+    size_t deadEntries = 0;
+};
+
+#endif // NODE_STORE_H
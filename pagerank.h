@@ -0,0 +1,121 @@
+#ifndef PAGERANK_H
+#define PAGERANK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Centrality scores over the frozen CSR rows.
+namespace centrality {
+
+struct PageRankOptions {
+    double damping = 0.85;
+    double tolerance = 1e-9; // stop when the L1 change between iterations drops below this
+    size_t maxIterations = 100;
+};
+
+struct PageRankResult {
+    std::vector<double> scores;    // per dense vertex, summing to 1
+    std::vector<double> residuals; // L1 change of each iteration, for monitoring
+    bool converged = false;
+};
+
+// Splits rows [0, rowCount) into `parts` ranges of roughly equal edge count,
+// so one hub does not leave the other workers idle.
+inline std::vector<size_t> edgeBalancedBounds(const CsrGraph& graph, size_t parts) {
+    const std::vector<uint64_t>& offsets = graph.rowOffsets();
+    size_t rows = graph.rowCount();
+    std::vector<size_t> bounds(parts + 1, rows);
+    bounds[0] = 0;
+    // Each row also counts as one unit of work so edge-free stretches split too.
+    uint64_t total = offsets[rows] + rows;
+    for (size_t p = 1; p < parts; ++p) {
+        uint64_t goal = total * p / parts;
+        size_t lo = bounds[p - 1], hi = rows;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (offsets[mid] + mid < goal) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        bounds[p] = lo;
+    }
+    return bounds;
+}
+
+// Pull-based power iteration: each vertex sums contrib[u] = rank[u] / deg(u)
+// over its own row, so no two workers write the same slot. Rank held by
+// isolated vertices is spread uniformly, as is the teleport term.
+inline PageRankResult pageRank(const CsrGraph& graph, const PageRankOptions& options = {}) {
+    PageRankResult result;
+    size_t n = graph.rowCount();
+    if (n == 0) {
+        result.converged = true;
+        return result;
+    }
+    const std::vector<uint64_t>& offsets = graph.rowOffsets();
+    const std::vector<uint32_t>& targets = graph.rowTargets();
+
+    unsigned workers = parallel::blockCount(offsets[n] + n, 1 << 16);
+    std::vector<size_t> bounds = edgeBalancedBounds(graph, workers);
+
+    std::vector<double> rank(n, 1.0 / n), next(n), contrib(n);
+    std::vector<double> partial(workers);
+    for (size_t iteration = 0; iteration < options.maxIterations; ++iteration) {
+        parallel::forBlocks(workers, [&](size_t begin, size_t end, unsigned) {
+            for (size_t w = begin; w < end; ++w) {
+                double dangling = 0;
+                for (size_t v = bounds[w]; v < bounds[w + 1]; ++v) {
+                    uint64_t degree = offsets[v + 1] - offsets[v];
+                    contrib[v] = degree ? rank[v] / degree : 0;
+                    dangling += degree ? 0 : rank[v];
+                }
+                partial[w] = dangling;
+            }
+        }, 1, workers);
+        double dangling = 0;
+        for (double d : partial) {
+            dangling += d;
+        }
+
+        double base = (1 - options.damping) / n + options.damping * dangling / n;
+        parallel::forBlocks(workers, [&](size_t begin, size_t end, unsigned) {
+            for (size_t w = begin; w < end; ++w) {
+                double change = 0;
+                for (size_t v = bounds[w]; v < bounds[w + 1]; ++v) {
+                    double sum = 0;
+                    for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                        sum += contrib[targets[e]];
+                    }
+                    next[v] = base + options.damping * sum;
+                    change += std::fabs(next[v] - rank[v]);
+                }
+                partial[w] = change;
+            }
+        }, 1, workers);
+        double residual = 0;
+        for (double c : partial) {
+            residual += c;
+        }
+
+        rank.swap(next);
+        result.residuals.push_back(residual);
+        if (residual < options.tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+    result.scores = std::move(rank);
+    return result;
+}
+
+} // namespace centrality
+
+#endif // PAGERANK_H
@@ -0,0 +1,49 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Minimal fork-join helpers over std::thread. Work is split into one
+// contiguous block per worker; small inputs run inline on the caller.
+namespace parallel {
+
+inline unsigned threadCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// Calls f(begin, end, worker) for disjoint blocks covering [0, count).
+// Blocks are at least `grain` items so tiny loops do not pay for threads.
+template <typename F>
+void forBlocks(size_t count, F f, size_t grain = 4096, unsigned threads = threadCount()) {
+    size_t workers = std::min<size_t>(std::max(1u, threads), std::max<size_t>(1, count / std::max<size_t>(1, grain)));
+    if (workers <= 1) {
+        f(size_t(0), count, 0u);
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+        pool.emplace_back([&f, count, workers, w] {
+            f(count * w / workers, count * (w + 1) / workers, static_cast<unsigned>(w));
+        });
+    }
+    f(size_t(0), count / workers, 0u);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+// Number of workers forBlocks will use for the same arguments, so callers can
+// size per-worker buffers up front.
+inline unsigned blockCount(size_t count, size_t grain = 4096, unsigned threads = threadCount()) {
+    return static_cast<unsigned>(
+        std::min<size_t>(std::max(1u, threads), std::max<size_t>(1, count / std::max<size_t>(1, grain))));
+}
+
+} // namespace parallel
+
+#endif // PARALLEL_H
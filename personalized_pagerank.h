@@ -0,0 +1,274 @@
+#ifndef PERSONALIZED_PAGERANK_H
+#define PERSONALIZED_PAGERANK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "counter_rng.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Personalized PageRank from one source, for "people you may know": the
+// probability that a random walk from the source, stopping with probability
+// alpha at every step, stops at each vertex.
+namespace centrality {
+
+struct PersonalizedOptions {
+    double alpha = 0.15;          // stop probability per step
+    double pushThreshold = 1e-4;  // first push threshold: push while residual >= this * degree
+    double epsilon = 1e-3;        // target absolute error per score
+    double failure = 0.01;        // probability that a score misses epsilon
+    size_t maxWalks = size_t(1) << 16; // cap per query, for latency; error reports the bound reached
+    uint64_t seed = 1;
+};
+
+struct Recommendation {
+    uint32_t vertex;
+    double score;
+};
+
+struct PersonalizedResult {
+    std::vector<Recommendation> top; // non-neighbors by score descending, then vertex ascending
+    double error = 0;                // every score is within this of the true PPR with probability 1 - failure
+    size_t pushes = 0;
+    size_t walks = 0;
+    double pushThreshold = 0; // where pushing stopped
+};
+
+// Top-k recommendations of every vertex v at [offsets[v], offsets[v + 1]).
+struct RecommendationTable {
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint32_t> vertices;
+    std::vector<float> scores;
+
+    size_t vertexCount() const { return offsets.size() - 1; }
+};
+
+namespace detail {
+
+// Dense per-vertex state reused across queries; only touched entries are
+// reset, so a query costs what it explores rather than the vertex count.
+struct PersonalizedWorkspace {
+    std::vector<double> estimate;
+    std::vector<double> residual;
+    std::vector<uint8_t> queued;
+    std::vector<uint32_t> touched;
+    std::vector<uint32_t> queue;
+
+    void prepare(size_t n) {
+        if (estimate.size() != n) {
+            estimate.assign(n, 0);
+            residual.assign(n, 0);
+            queued.assign(n, 0);
+        }
+    }
+
+    void touch(uint32_t v) {
+        if (estimate[v] == 0 && residual[v] == 0) {
+            touched.push_back(v);
+        }
+    }
+
+    void reset() {
+        for (uint32_t v : touched) {
+            estimate[v] = 0;
+            residual[v] = 0;
+            queued[v] = 0;
+        }
+        touched.clear();
+        queue.clear();
+    }
+};
+
+} // namespace detail
+
+// FORA-style estimate (Wang et al., KDD 2017). Forward push moves residual
+// mass until every residual is below a threshold times the degree, and
+// random walks finish the remaining residual r_sum. Walks start from each
+// residual vertex in proportion to its residual and each adds at most
+// r_sum / W to its endpoint, so by Hoeffding W = r_sum^2 ln(2 / failure) /
+// (2 epsilon^2) walks keep every score within epsilon. With W capped at
+// maxWalks the bound actually reached is returned as `error`. Walks are
+// seeded by (seed, source), so results do not depend on which thread ran
+// the query.
+inline PersonalizedResult personalizedPageRank(const CsrGraph& graph, uint32_t source, size_t k,
+                                               const PersonalizedOptions& options,
+                                               detail::PersonalizedWorkspace& workspace) {
+    PersonalizedResult result;
+    size_t n = graph.rowCount();
+    if (source >= n) {
+        return result;
+    }
+    const std::vector<uint64_t>& offsets = graph.rowOffsets();
+    const std::vector<uint32_t>& targets = graph.rowTargets();
+    const double alpha = options.alpha;
+    workspace.prepare(n);
+    std::vector<double>& estimate = workspace.estimate;
+    std::vector<double>& residual = workspace.residual;
+
+    // Pushing is cheap per unit of mass but its cost grows as the threshold
+    // drops, while the walks needed shrink with the square of the residual
+    // left. Start coarse and lower the threshold 4x at a time while the
+    // walks would still cost more than all pushing so far. Pushing never
+    // costs more edge visits than the longest allowed walk phase has steps;
+    // stopping mid-queue is safe, since the push invariant holds after
+    // every single push.
+    const double logTerm = std::log(2 / options.failure);
+    auto walksFor = [&](double residualSum) {
+        double wanted = std::ceil(residualSum * residualSum * logTerm / (2 * options.epsilon * options.epsilon));
+        return std::min(wanted, static_cast<double>(options.maxWalks));
+    };
+    workspace.touch(source);
+    residual[source] = 1;
+    double threshold = options.pushThreshold;
+    double edgeVisits = 0;
+    const double pushBudget = static_cast<double>(options.maxWalks) / alpha;
+    double residualSum = 1;
+    for (;;) {
+        for (uint32_t v : workspace.touched) {
+            uint64_t degree = offsets[v + 1] - offsets[v];
+            if (!workspace.queued[v] && residual[v] > 0 && residual[v] >= threshold * std::max<uint64_t>(1, degree)) {
+                workspace.queued[v] = 1;
+                workspace.queue.push_back(v);
+            }
+        }
+        for (size_t head = 0; head < workspace.queue.size(); ++head) {
+            if (edgeVisits >= pushBudget) {
+                for (; head < workspace.queue.size(); ++head) {
+                    workspace.queued[workspace.queue[head]] = 0;
+                }
+                break;
+            }
+            uint32_t v = workspace.queue[head];
+            workspace.queued[v] = 0;
+            uint64_t degree = offsets[v + 1] - offsets[v];
+            double mass = residual[v];
+            residual[v] = 0;
+            ++result.pushes;
+            edgeVisits += static_cast<double>(degree) + 1;
+            if (degree == 0) {
+                // A walk stuck here stops here.
+                estimate[v] += mass;
+                continue;
+            }
+            estimate[v] += alpha * mass;
+            double share = (1 - alpha) * mass / static_cast<double>(degree);
+            for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                uint32_t u = targets[e];
+                workspace.touch(u);
+                residual[u] += share;
+                uint64_t uDegree = offsets[u + 1] - offsets[u];
+                if (!workspace.queued[u] && residual[u] >= threshold * std::max<uint64_t>(1, uDegree)) {
+                    workspace.queued[u] = 1;
+                    workspace.queue.push_back(u);
+                }
+            }
+        }
+        workspace.queue.clear();
+
+        residualSum = 0;
+        for (uint32_t v : workspace.touched) {
+            residualSum += residual[v];
+        }
+        if (residualSum <= 0 || walksFor(residualSum) / alpha <= edgeVisits || edgeVisits >= pushBudget ||
+            threshold < 1e-12) {
+            break;
+        }
+        threshold /= 4;
+    }
+    result.pushThreshold = threshold;
+
+    if (residualSum > 0) {
+        size_t budget = std::max<size_t>(1, static_cast<size_t>(walksFor(residualSum)));
+        result.error = residualSum * std::sqrt(logTerm / (2 * static_cast<double>(budget)));
+
+        // Walk lengths are geometric, so each walk draws its length once and
+        // then one neighbor per step.
+        CounterRng rng(options.seed, source);
+        const double logContinue = std::log1p(-alpha);
+        size_t touchedBeforeWalks = workspace.touched.size();
+        for (size_t i = 0; i < touchedBeforeWalks; ++i) {
+            uint32_t start = workspace.touched[i];
+            double mass = residual[start];
+            if (mass <= 0) {
+                continue;
+            }
+            size_t walks = static_cast<size_t>(std::ceil(mass / residualSum * static_cast<double>(budget)));
+            double credit = mass / static_cast<double>(walks);
+            for (size_t w = 0; w < walks; ++w) {
+                uint32_t at = start;
+                double steps = std::floor(std::log(1 - rng.uniform()) / logContinue);
+                for (; steps > 0 && offsets[at + 1] != offsets[at]; --steps) {
+                    at = targets[offsets[at] + rng.below(offsets[at + 1] - offsets[at])];
+                }
+                workspace.touch(at);
+                estimate[at] += credit;
+            }
+            result.walks += walks;
+        }
+    }
+
+    // Candidates are everything touched except the source and its friends.
+    const uint32_t* friendsBegin = targets.data() + offsets[source];
+    const uint32_t* friendsEnd = targets.data() + offsets[source + 1];
+    for (uint32_t v : workspace.touched) {
+        if (v != source && estimate[v] > 0 && !std::binary_search(friendsBegin, friendsEnd, v)) {
+            result.top.push_back({v, estimate[v]});
+        }
+    }
+    auto better = [](const Recommendation& a, const Recommendation& b) {
+        return a.score > b.score || (a.score == b.score && a.vertex < b.vertex);
+    };
+    size_t shown = std::min(k, result.top.size());
+    std::partial_sort(result.top.begin(), result.top.begin() + shown, result.top.end(), better);
+    result.top.resize(shown);
+    workspace.reset();
+    return result;
+}
+
+inline PersonalizedResult personalizedPageRank(const CsrGraph& graph, uint32_t source, size_t k,
+                                               const PersonalizedOptions& options = {}) {
+    detail::PersonalizedWorkspace workspace;
+    return personalizedPageRank(graph, source, k, options, workspace);
+}
+
+// Top k recommendations for every vertex: one query per source, each worker
+// reusing one workspace over its block of sources.
+inline RecommendationTable recommendAll(const CsrGraph& graph, size_t k, const PersonalizedOptions& options = {}) {
+    size_t n = graph.rowCount();
+    unsigned workers = parallel::blockCount(n, 64);
+    std::vector<RecommendationTable> parts(workers);
+    std::vector<std::vector<uint64_t>> lengths(workers);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned worker) {
+        detail::PersonalizedWorkspace workspace;
+        RecommendationTable& part = parts[worker];
+        for (size_t v = begin; v < end; ++v) {
+            PersonalizedResult result = personalizedPageRank(graph, static_cast<uint32_t>(v), k, options, workspace);
+            for (const Recommendation& r : result.top) {
+                part.vertices.push_back(r.vertex);
+                part.scores.push_back(static_cast<float>(r.score));
+            }
+            lengths[worker].push_back(result.top.size());
+        }
+    }, 64);
+
+    // Blocks are contiguous and in worker order, so the parts concatenate.
+    RecommendationTable table;
+    table.offsets.reserve(n + 1);
+    for (unsigned w = 0; w < workers; ++w) {
+        for (uint64_t length : lengths[w]) {
+            table.offsets.push_back(table.offsets.back() + length);
+        }
+        table.vertices.insert(table.vertices.end(), parts[w].vertices.begin(), parts[w].vertices.end());
+        table.scores.insert(table.scores.end(), parts[w].scores.begin(), parts[w].scores.end());
+        parts[w] = RecommendationTable();
+    }
+    return table;
+}
+
+} // namespace centrality
+
+#endif // PERSONALIZED_PAGERANK_H
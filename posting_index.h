@@ -0,0 +1,100 @@
+#ifndef POSTING_INDEX_H
+#define POSTING_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "roaring_bitmap.h"
+
+// Characteristic ID -> set of declared vertices that hold it, plus the set
+// of all declared vertices. Each set is a RoaringBitmap, so rare
+// characteristics stay sorted 16-bit arrays and common ones become dense
+// bitmaps handled by the SIMD kernels.
+class PostingIndex {
+public:
+    size_t size() const { return lists.size(); }
+
+    const RoaringBitmap& list(uint32_t characteristic) const {
+        return characteristic < lists.size() ? lists[characteristic] : emptyList;
+    }
+
+    const RoaringBitmap& declared() const { return all; }
+
+    // Replaces v's characteristics: `before` and `after` are sorted ID runs.
+    void update(uint32_t v, const uint32_t* beforeBegin, const uint32_t* beforeEnd,
+                const uint32_t* afterBegin, const uint32_t* afterEnd) {
+        all.add(v);
+        for (const uint32_t* p = beforeBegin; p != beforeEnd; ++p) {
+            if (!std::binary_search(afterBegin, afterEnd, *p)) {
+                lists[*p].remove(v);
+            }
+        }
+        for (const uint32_t* p = afterBegin; p != afterEnd; ++p) {
+            if (*p >= lists.size()) {
+                lists.resize(*p + 1);
+            }
+            lists[*p].add(v);
+        }
+    }
+
+    // Bulk build from node columns: runs(v) returns v's IDs as a pointer pair,
+    // or nothing if v is not declared.
+    template <typename Runs>
+    void rebuild(size_t vertexCount, size_t characteristicCount, Runs runs) {
+        lists.assign(characteristicCount, RoaringBitmap());
+        all = RoaringBitmap();
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            auto run = runs(v);
+            if (!run) {
+                continue;
+            }
+            all.add(v);
+            for (const uint32_t* p = run->first; p != run->second; ++p) {
+                lists[*p].add(v);
+            }
+        }
+    }
+
+    // Vertices holding every characteristic in `targets`; all declared
+    // vertices when `targets` is empty. ANDs from the smallest set upwards and
+    // stops as soon as the running result is empty.
+    RoaringBitmap intersect(const std::vector<uint32_t>& targets) const {
+        if (targets.empty()) {
+            return all;
+        }
+        std::vector<const RoaringBitmap*> order;
+        for (uint32_t characteristic : targets) {
+            order.push_back(&list(characteristic));
+        }
+        std::sort(order.begin(), order.end(), [](const RoaringBitmap* a, const RoaringBitmap* b) {
+            return a->cardinality() < b->cardinality();
+        });
+        RoaringBitmap result = *order.front();
+        for (size_t i = 1; i < order.size() && !result.empty(); ++i) {
+            result = RoaringBitmap::andOf(result, *order[i]);
+        }
+        return result;
+    }
+
+    void clear() {
+        lists.clear();
+        all = RoaringBitmap();
+    }
+
+    size_t memoryBytes() const {
+        size_t total = all.memoryBytes();
+        for (const auto& list : lists) {
+            total += list.memoryBytes();
+        }
+        return total;
+    }
+
+private:
+    std::vector<RoaringBitmap> lists;
+    RoaringBitmap all;
+    RoaringBitmap emptyList;
+};
+
+#endif // POSTING_INDEX_H
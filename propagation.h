@@ -0,0 +1,151 @@
+#ifndef PROPAGATION_H
+#define PROPAGATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "parallel.h"
+
+// Multi-hop spread of a post over the friendship graph. Seeds are reached at
+// hop 0; at each later hop the post moves to every neighbor of the current
+// frontier that passes the acceptance predicate and was not reached before.
+//
+// The search is a direction-optimizing BFS (Beamer et al.): small frontiers
+// push along their own edges (top-down); once the frontier's edges outweigh
+// those of the vertices still waiting, each waiting vertex instead looks for
+// any neighbor in the frontier (bottom-up) and stops at the first hit.
+namespace propagation {
+
+constexpr int32_t kUnreached = -1;
+
+// Switch heuristics from the paper: go bottom-up when frontier edges exceed
+// unexplored edges / kAlpha, back top-down when the frontier drops below
+// vertexCount / kBeta.
+constexpr size_t kAlpha = 14;
+constexpr size_t kBeta = 24;
+
+struct Result {
+    std::vector<uint32_t> reached;  // dense vertices by hop, ascending within a hop
+    std::vector<int32_t> hop;       // per dense vertex; kUnreached if never reached
+    std::vector<size_t> perHop;     // perHop[h] = vertices first reached at hop h
+};
+
+namespace detail {
+
+inline bool testBit(const std::vector<uint64_t>& bits, uint32_t v) { return (bits[v >> 6] >> (v & 63)) & 1; }
+
+// Claims u for hop h unless another worker got there first.
+inline bool claim(int32_t& slot, int32_t h) {
+    int32_t expected = kUnreached;
+    return __atomic_compare_exchange_n(&slot, &expected, h, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+} // namespace detail
+
+// Spreads from `seeds` (dense indexes below vertexCount) to vertices for which
+// accept(v) is true, for at most maxHops hops (negative means no limit).
+// accept is evaluated once per vertex, in parallel.
+template <typename Accept>
+Result spread(const CsrGraph& graph, size_t vertexCount, const std::vector<uint32_t>& seeds, Accept accept,
+              int maxHops = -1) {
+    Result result;
+    result.hop.assign(vertexCount, kUnreached);
+
+    std::vector<uint8_t> eligible(vertexCount);
+    std::vector<size_t> eligibleEdges(parallel::blockCount(vertexCount));
+    parallel::forBlocks(vertexCount, [&](size_t begin, size_t end, unsigned worker) {
+        size_t edges = 0;
+        for (size_t v = begin; v < end; ++v) {
+            eligible[v] = accept(static_cast<uint32_t>(v)) ? 1 : 0;
+            edges += eligible[v] ? graph.degree(static_cast<uint32_t>(v)) : 0;
+        }
+        eligibleEdges[worker] = edges;
+    });
+    size_t unexploredEdges = 0;
+    for (size_t edges : eligibleEdges) {
+        unexploredEdges += edges;
+    }
+
+    std::vector<uint32_t> frontier;
+    for (uint32_t seed : seeds) {
+        if (seed < vertexCount && result.hop[seed] == kUnreached) {
+            result.hop[seed] = 0;
+            frontier.push_back(seed);
+            unexploredEdges -= eligible[seed] ? graph.degree(seed) : 0;
+        }
+    }
+    std::sort(frontier.begin(), frontier.end());
+
+    std::vector<uint64_t> frontierBits;
+    bool bottomUp = false;
+    for (int32_t h = 0; !frontier.empty(); ++h) {
+        result.perHop.push_back(frontier.size());
+        result.reached.insert(result.reached.end(), frontier.begin(), frontier.end());
+        if (maxHops >= 0 && h >= maxHops) {
+            break;
+        }
+
+        size_t frontierEdges = 0;
+        for (uint32_t v : frontier) {
+            frontierEdges += graph.degree(v);
+        }
+        if (!bottomUp && frontierEdges > unexploredEdges / kAlpha) {
+            bottomUp = true;
+        } else if (bottomUp && frontier.size() < vertexCount / kBeta) {
+            bottomUp = false;
+        }
+
+        std::vector<std::vector<uint32_t>> found;
+        if (bottomUp) {
+            frontierBits.assign((vertexCount + 63) / 64, 0);
+            for (uint32_t v : frontier) {
+                frontierBits[v >> 6] |= uint64_t(1) << (v & 63);
+            }
+            // Blocks cover whole bitmap words, so each vertex has one owner and
+            // its hop can be written without atomics.
+            size_t words = frontierBits.size();
+            found.resize(parallel::blockCount(words, 64));
+            parallel::forBlocks(words, [&](size_t begin, size_t end, unsigned worker) {
+                size_t last = std::min(end * 64, vertexCount);
+                for (size_t v = begin * 64; v < last; ++v) {
+                    if (!eligible[v] || result.hop[v] != kUnreached) {
+                        continue;
+                    }
+                    if (graph.anyNeighbor(static_cast<uint32_t>(v),
+                                          [&](uint32_t u) { return detail::testBit(frontierBits, u); })) {
+                        result.hop[v] = h + 1;
+                        found[worker].push_back(static_cast<uint32_t>(v));
+                    }
+                }
+            }, 64);
+        } else {
+            found.resize(parallel::blockCount(frontier.size(), 256));
+            parallel::forBlocks(frontier.size(), [&](size_t begin, size_t end, unsigned worker) {
+                for (size_t i = begin; i < end; ++i) {
+                    graph.forEachNeighbor(frontier[i], [&](uint32_t u) {
+                        if (u < vertexCount && eligible[u] && detail::claim(result.hop[u], h + 1)) {
+                            found[worker].push_back(u);
+                        }
+                    });
+                }
+            }, 256);
+        }
+
+        frontier.clear();
+        for (const auto& part : found) {
+            frontier.insert(frontier.end(), part.begin(), part.end());
+        }
+        std::sort(frontier.begin(), frontier.end());
+        for (uint32_t v : frontier) {
+            unexploredEdges -= graph.degree(v);
+        }
+    }
+    return result;
+}
+
+} // namespace propagation
+
+#endif // PROPAGATION_H
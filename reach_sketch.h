@@ -0,0 +1,152 @@
+#ifndef REACH_SKETCH_H
+#define REACH_SKETCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "counter_rng.h"
+#include "csr_graph.h"
+#include "parallel.h"
+#include "register_kernels.h"
+
+// Approximate k-hop reach in the style of HyperANF (Boldi, Rosa and Vigna,
+// 2011). Every vertex starts with a HyperLogLog sketch of itself; round t
+// sets each sketch to the register-wise max over the vertex and its
+// neighbors, so level t sketches the ball of radius t. Levels 0..hops are
+// kept, and the reach of any vertex set is the union (again a register max)
+// of its members' sketches: O(|set| * 2^precision) bytes per query, with no
+// traversal.
+namespace reach {
+
+// Levels kept at most. Sketches stop changing once the hop count passes the
+// graph's diameter, which for social graphs is well below this, and each
+// level costs n * 2^precision bytes.
+constexpr size_t kMaxHops = 16;
+
+struct Options {
+    size_t hops = 3; // clamped to kMaxHops
+    unsigned precision = 7; // 2^precision registers per vertex and level; clamped to [4, 12]
+    uint64_t seed = 1;
+};
+
+struct Estimate {
+    double value = 0;
+    double low = 0;  // value minus two standard errors (about 95%)
+    double high = 0; // value plus two standard errors, capped at the vertex count
+};
+
+class Sketch {
+public:
+    static Sketch build(const CsrGraph& graph, const Options& options = {}) {
+        Sketch sketch;
+        sketch.precision = std::min(12u, std::max(4u, options.precision));
+        sketch.width = size_t(1) << sketch.precision;
+        sketch.n = graph.rowCount();
+        const size_t m = sketch.width;
+        const size_t n = sketch.n;
+        const size_t hops = std::min(options.hops, kMaxHops);
+        sketch.levels.assign(hops + 1, std::vector<uint8_t>());
+
+        std::vector<uint8_t>& first = sketch.levels[0];
+        first.assign(n * m, 0);
+        unsigned p = sketch.precision;
+        parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+            for (size_t v = begin; v < end; ++v) {
+                uint64_t hash = CounterRng::mix(v * 0x9E3779B97F4A7C15ULL ^ CounterRng::mix(options.seed));
+                uint64_t rest = hash << p;
+                uint8_t rank = static_cast<uint8_t>(rest ? __builtin_clzll(rest) + 1 : 64 - p + 1);
+                first[v * m + (hash >> (64 - p))] = rank;
+            }
+        });
+
+        kernels::MaxBytesOp merge = kernels::maxBytes();
+        const std::vector<uint64_t>& offsets = graph.rowOffsets();
+        const std::vector<uint32_t>& targets = graph.rowTargets();
+        for (size_t hop = 1; hop <= hops; ++hop) {
+            const std::vector<uint8_t>& previous = sketch.levels[hop - 1];
+            std::vector<uint8_t> next(previous);
+            parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+                for (size_t v = begin; v < end; ++v) {
+                    uint8_t* into = next.data() + v * m;
+                    for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                        merge(into, previous.data() + size_t(targets[e]) * m, m);
+                    }
+                }
+            }, 256);
+            sketch.levels[hop] = std::move(next);
+        }
+        return sketch;
+    }
+
+    size_t hops() const { return levels.empty() ? 0 : levels.size() - 1; }
+    size_t vertexCount() const { return n; }
+
+    // Relative standard error of one estimate, 1.04 / sqrt(registers).
+    double relativeError() const { return 1.04 / std::sqrt(static_cast<double>(width)); }
+
+    size_t memoryBytes() const { return levels.size() * n * width; }
+
+    // Estimated number of vertices within k hops of `vertices`, for
+    // k = 0..hops(). Members are merged per worker, then the workers' unions.
+    std::vector<Estimate> estimate(const std::vector<uint32_t>& vertices) const {
+        kernels::MaxBytesOp merge = kernels::maxBytes();
+        size_t levelCount = levels.size();
+        size_t m = width;
+        std::vector<std::vector<uint8_t>> partial(parallel::blockCount(vertices.size(), 1024),
+                                                  std::vector<uint8_t>(levelCount * m, 0));
+        parallel::forBlocks(vertices.size(), [&](size_t begin, size_t end, unsigned worker) {
+            for (size_t i = begin; i < end; ++i) {
+                if (vertices[i] >= n) {
+                    continue;
+                }
+                for (size_t level = 0; level < levelCount; ++level) {
+                    merge(partial[worker].data() + level * m, levels[level].data() + size_t(vertices[i]) * m, m);
+                }
+            }
+        }, 1024);
+        for (size_t w = 1; w < partial.size(); ++w) {
+            merge(partial[0].data(), partial[w].data(), levelCount * m);
+        }
+
+        std::vector<Estimate> result;
+        double floor = 0;
+        for (size_t level = 0; level < levelCount; ++level) {
+            // Balls only grow with k; keep the estimates monotone too.
+            double value = std::min(static_cast<double>(n), std::max(floor, count(partial[0].data() + level * m)));
+            floor = value;
+            double spread = 2 * relativeError() * value;
+            result.push_back({value, std::max(0.0, value - spread), std::min(static_cast<double>(n), value + spread)});
+        }
+        return result;
+    }
+
+private:
+    // HyperLogLog estimate with linear counting for small cardinalities.
+    double count(const uint8_t* registers) const {
+        double m = static_cast<double>(width);
+        double sum = 0;
+        size_t zeros = 0;
+        for (size_t j = 0; j < width; ++j) {
+            sum += std::ldexp(1.0, -registers[j]);
+            zeros += registers[j] == 0;
+        }
+        double alpha = width == 16 ? 0.673 : width == 32 ? 0.697 : width == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m);
+        double raw = alpha * m * m / sum;
+        if (raw <= 2.5 * m && zeros > 0) {
+            return m * std::log(m / static_cast<double>(zeros));
+        }
+        return raw;
+    }
+
+    unsigned precision = 7;
+    size_t width = 128;
+    size_t n = 0;
+    std::vector<std::vector<uint8_t>> levels; // levels[k][v * width + j]
+};
+
+} // namespace reach
+
+#endif // REACH_SKETCH_H
@@ -0,0 +1,81 @@
+#ifndef REGISTER_KERNELS_H
+#define REGISTER_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define REGISTER_KERNELS_X86 1
+#endif
+
+// dst[i] = max(dst[i], src[i]) over byte arrays: the union of two
+// HyperLogLog register sets. Picked for the running CPU on first use, as in
+// bitset_kernels.h.
+namespace kernels {
+
+using MaxBytesOp = void (*)(uint8_t* dst, const uint8_t* src, size_t count);
+
+namespace scalar {
+
+inline void maxBytes(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = dst[i] < src[i] ? src[i] : dst[i];
+    }
+}
+
+} // namespace scalar
+
+#ifdef REGISTER_KERNELS_X86
+
+namespace avx2 {
+
+__attribute__((target("avx2"))) inline void maxBytes(uint8_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu8(x, y));
+    }
+    scalar::maxBytes(dst + i, src + i, count - i);
+}
+
+} // namespace avx2
+
+namespace avx512 {
+
+__attribute__((target("avx512f,avx512bw"))) inline void maxBytes(uint8_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64) {
+        __m512i x = _mm512_loadu_si512(dst + i);
+        __m512i y = _mm512_loadu_si512(src + i);
+        _mm512_storeu_si512(dst + i, _mm512_max_epu8(x, y));
+    }
+    scalar::maxBytes(dst + i, src + i, count - i);
+}
+
+} // namespace avx512
+
+#endif // REGISTER_KERNELS_X86
+
+inline MaxBytesOp selectMaxBytes() {
+#ifdef REGISTER_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        return avx512::maxBytes;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2::maxBytes;
+    }
+#endif
+    return scalar::maxBytes;
+}
+
+inline MaxBytesOp maxBytes() {
+    static const MaxBytesOp selected = selectMaxBytes();
+    return selected;
+}
+
+} // namespace kernels
+
+#endif // REGISTER_KERNELS_H
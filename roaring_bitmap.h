@@ -0,0 +1,386 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "bitset_kernels.h"
+
+// Compressed set of uint32 values in the style of Roaring bitmaps. The value
+// space is cut into 2^16-wide chunks keyed by the high 16 bits; each non-empty
+// chunk is either a sorted array of low halves (sparse, up to kArrayMax
+// values) or a 1024-word bitmap (dense). Dense-dense operations run through
+// the SIMD kernels in bitset_kernels.h.
+class RoaringBitmap {
+public:
+    static constexpr uint32_t kArrayMax = 4096;
+    static constexpr size_t kBitmapWords = 1024;
+
+    bool empty() const { return chunks.empty(); }
+
+    uint64_t cardinality() const {
+        uint64_t total = 0;
+        for (const auto& chunk : chunks) {
+            total += chunk.cardinality;
+        }
+        return total;
+    }
+
+    bool contains(uint32_t value) const {
+        const Chunk* chunk = find(high(value));
+        return chunk && chunk->contains(low(value));
+    }
+
+    void add(uint32_t value) {
+        Chunk& chunk = findOrInsert(high(value));
+        uint16_t lo = low(value);
+        if (chunk.isBitmap()) {
+            uint64_t& word = chunk.bits[lo >> 6];
+            uint64_t mask = uint64_t(1) << (lo & 63);
+            if (!(word & mask)) {
+                word |= mask;
+                ++chunk.cardinality;
+            }
+            return;
+        }
+        if (chunk.array.empty() || chunk.array.back() < lo) {
+            chunk.array.push_back(lo);
+        } else {
+            auto it = std::lower_bound(chunk.array.begin(), chunk.array.end(), lo);
+            if (*it == lo) {
+                return;
+            }
+            chunk.array.insert(it, lo);
+        }
+        ++chunk.cardinality;
+        if (chunk.cardinality > kArrayMax) {
+            chunk.toBitmap();
+        }
+    }
+
+    void remove(uint32_t value) {
+        auto it = lowerBound(high(value));
+        if (it == chunks.end() || it->key != high(value)) {
+            return;
+        }
+        Chunk& chunk = *it;
+        uint16_t lo = low(value);
+        if (chunk.isBitmap()) {
+            uint64_t& word = chunk.bits[lo >> 6];
+            uint64_t mask = uint64_t(1) << (lo & 63);
+            if (word & mask) {
+                word &= ~mask;
+                --chunk.cardinality;
+            }
+            if (chunk.cardinality <= kArrayMax) {
+                chunk.toArray();
+            }
+        } else {
+            auto pos = std::lower_bound(chunk.array.begin(), chunk.array.end(), lo);
+            if (pos == chunk.array.end() || *pos != lo) {
+                return;
+            }
+            chunk.array.erase(pos);
+            --chunk.cardinality;
+        }
+        if (chunk.cardinality == 0) {
+            chunks.erase(it);
+        }
+    }
+
+    // Visits values in ascending order.
+    template <typename F>
+    void forEach(F f) const {
+        for (const auto& chunk : chunks) {
+            uint32_t base = uint32_t(chunk.key) << 16;
+            if (chunk.isBitmap()) {
+                for (size_t w = 0; w < kBitmapWords; ++w) {
+                    uint64_t word = chunk.bits[w];
+                    while (word) {
+                        f(base | uint32_t(w * 64 + static_cast<size_t>(__builtin_ctzll(word))));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (uint16_t lo : chunk.array) {
+                    f(base | lo);
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> toVector() const {
+        std::vector<uint32_t> out;
+        out.reserve(cardinality());
+        forEach([&](uint32_t v) { out.push_back(v); });
+        return out;
+    }
+
+    // Sets every value in [0, n).
+    static RoaringBitmap range(uint32_t n) {
+        RoaringBitmap result;
+        for (uint32_t start = 0; start < n; start += 1u << 16) {
+            uint32_t count = std::min<uint32_t>(n - start, 1u << 16);
+            Chunk chunk(static_cast<uint16_t>(start >> 16));
+            if (count > kArrayMax) {
+                chunk.bits.assign(kBitmapWords, 0);
+                for (uint32_t i = 0; i < count / 64; ++i) {
+                    chunk.bits[i] = ~uint64_t(0);
+                }
+                if (count % 64) {
+                    chunk.bits[count / 64] = (uint64_t(1) << (count % 64)) - 1;
+                }
+            } else {
+                for (uint32_t i = 0; i < count; ++i) {
+                    chunk.array.push_back(static_cast<uint16_t>(i));
+                }
+            }
+            chunk.cardinality = count;
+            result.chunks.push_back(std::move(chunk));
+        }
+        return result;
+    }
+
+    static RoaringBitmap andOf(const RoaringBitmap& a, const RoaringBitmap& b) {
+        RoaringBitmap result;
+        size_t i = 0, j = 0;
+        while (i < a.chunks.size() && j < b.chunks.size()) {
+            if (a.chunks[i].key < b.chunks[j].key) {
+                ++i;
+            } else if (a.chunks[i].key > b.chunks[j].key) {
+                ++j;
+            } else {
+                Chunk chunk = andChunks(a.chunks[i++], b.chunks[j++]);
+                if (chunk.cardinality) {
+                    result.chunks.push_back(std::move(chunk));
+                }
+            }
+        }
+        return result;
+    }
+
+    static RoaringBitmap orOf(const RoaringBitmap& a, const RoaringBitmap& b) {
+        RoaringBitmap result;
+        size_t i = 0, j = 0;
+        while (i < a.chunks.size() || j < b.chunks.size()) {
+            if (j == b.chunks.size() || (i < a.chunks.size() && a.chunks[i].key < b.chunks[j].key)) {
+                result.chunks.push_back(a.chunks[i++]);
+            } else if (i == a.chunks.size() || b.chunks[j].key < a.chunks[i].key) {
+                result.chunks.push_back(b.chunks[j++]);
+            } else {
+                result.chunks.push_back(orChunks(a.chunks[i++], b.chunks[j++]));
+            }
+        }
+        return result;
+    }
+
+    // a AND NOT b.
+    static RoaringBitmap andNotOf(const RoaringBitmap& a, const RoaringBitmap& b) {
+        RoaringBitmap result;
+        size_t j = 0;
+        for (const auto& chunk : a.chunks) {
+            while (j < b.chunks.size() && b.chunks[j].key < chunk.key) {
+                ++j;
+            }
+            if (j == b.chunks.size() || b.chunks[j].key != chunk.key) {
+                result.chunks.push_back(chunk);
+                continue;
+            }
+            Chunk diff = andNotChunks(chunk, b.chunks[j]);
+            if (diff.cardinality) {
+                result.chunks.push_back(std::move(diff));
+            }
+        }
+        return result;
+    }
+
+    // |a AND b| without materializing the intersection.
+    static uint64_t andCardinality(const RoaringBitmap& a, const RoaringBitmap& b) {
+        uint64_t total = 0;
+        size_t i = 0, j = 0;
+        std::vector<uint64_t> scratch;
+        while (i < a.chunks.size() && j < b.chunks.size()) {
+            if (a.chunks[i].key < b.chunks[j].key) {
+                ++i;
+            } else if (a.chunks[i].key > b.chunks[j].key) {
+                ++j;
+            } else {
+                const Chunk& x = a.chunks[i++];
+                const Chunk& y = b.chunks[j++];
+                if (x.isBitmap() && y.isBitmap()) {
+                    scratch.resize(kBitmapWords);
+                    total += kernels::ops().andWords(x.bits.data(), y.bits.data(), scratch.data(), kBitmapWords);
+                } else {
+                    total += andChunks(x, y).cardinality;
+                }
+            }
+        }
+        return total;
+    }
+
+    size_t memoryBytes() const {
+        size_t total = chunks.capacity() * sizeof(Chunk);
+        for (const auto& chunk : chunks) {
+            total += chunk.array.capacity() * sizeof(uint16_t) + chunk.bits.capacity() * sizeof(uint64_t);
+        }
+        return total;
+    }
+
+private:
+    struct Chunk {
+        uint16_t key;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array; // used while sparse
+        std::vector<uint64_t> bits;  // kBitmapWords words once dense
+
+        explicit Chunk(uint16_t key) : key(key) {}
+
+        bool isBitmap() const { return !bits.empty(); }
+
+        bool contains(uint16_t lo) const {
+            if (isBitmap()) {
+                return (bits[lo >> 6] >> (lo & 63)) & 1;
+            }
+            return std::binary_search(array.begin(), array.end(), lo);
+        }
+
+        void toBitmap() {
+            bits.assign(kBitmapWords, 0);
+            for (uint16_t lo : array) {
+                bits[lo >> 6] |= uint64_t(1) << (lo & 63);
+            }
+            array.clear();
+            array.shrink_to_fit();
+        }
+
+        void toArray() {
+            array.clear();
+            array.reserve(cardinality);
+            for (size_t w = 0; w < kBitmapWords; ++w) {
+                uint64_t word = bits[w];
+                while (word) {
+                    array.push_back(static_cast<uint16_t>(w * 64 + static_cast<size_t>(__builtin_ctzll(word))));
+                    word &= word - 1;
+                }
+            }
+            bits.clear();
+            bits.shrink_to_fit();
+        }
+
+        // Picks the representation that fits the cardinality.
+        void normalize() {
+            if (isBitmap() && cardinality <= kArrayMax) {
+                toArray();
+            } else if (!isBitmap() && cardinality > kArrayMax) {
+                toBitmap();
+            }
+        }
+    };
+
+    static Chunk andChunks(const Chunk& a, const Chunk& b) {
+        Chunk out(a.key);
+        if (a.isBitmap() && b.isBitmap()) {
+            out.bits.resize(kBitmapWords);
+            out.cardinality = static_cast<uint32_t>(
+                kernels::ops().andWords(a.bits.data(), b.bits.data(), out.bits.data(), kBitmapWords));
+            out.normalize();
+        } else if (a.isBitmap() || b.isBitmap()) {
+            const Chunk& sparse = a.isBitmap() ? b : a;
+            const Chunk& dense = a.isBitmap() ? a : b;
+            for (uint16_t lo : sparse.array) {
+                if (dense.contains(lo)) {
+                    out.array.push_back(lo);
+                }
+            }
+            out.cardinality = static_cast<uint32_t>(out.array.size());
+        } else {
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                  std::back_inserter(out.array));
+            out.cardinality = static_cast<uint32_t>(out.array.size());
+        }
+        return out;
+    }
+
+    static Chunk orChunks(const Chunk& a, const Chunk& b) {
+        Chunk out(a.key);
+        if (a.isBitmap() && b.isBitmap()) {
+            out.bits.resize(kBitmapWords);
+            out.cardinality = static_cast<uint32_t>(
+                kernels::ops().orWords(a.bits.data(), b.bits.data(), out.bits.data(), kBitmapWords));
+        } else if (a.isBitmap() || b.isBitmap()) {
+            const Chunk& sparse = a.isBitmap() ? b : a;
+            out.bits = (a.isBitmap() ? a : b).bits;
+            for (uint16_t lo : sparse.array) {
+                out.bits[lo >> 6] |= uint64_t(1) << (lo & 63);
+            }
+            out.cardinality = static_cast<uint32_t>(kernels::ops().popcount(out.bits.data(), kBitmapWords));
+        } else {
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                           std::back_inserter(out.array));
+            out.cardinality = static_cast<uint32_t>(out.array.size());
+            out.normalize();
+        }
+        return out;
+    }
+
+    static Chunk andNotChunks(const Chunk& a, const Chunk& b) {
+        Chunk out(a.key);
+        if (a.isBitmap() && b.isBitmap()) {
+            out.bits.resize(kBitmapWords);
+            out.cardinality = static_cast<uint32_t>(
+                kernels::ops().andNotWords(a.bits.data(), b.bits.data(), out.bits.data(), kBitmapWords));
+            out.normalize();
+        } else if (a.isBitmap()) {
+            out.bits = a.bits;
+            out.cardinality = a.cardinality;
+            for (uint16_t lo : b.array) {
+                uint64_t mask = uint64_t(1) << (lo & 63);
+                if (out.bits[lo >> 6] & mask) {
+                    out.bits[lo >> 6] &= ~mask;
+                    --out.cardinality;
+                }
+            }
+            out.normalize();
+        } else {
+            for (uint16_t lo : a.array) {
+                if (!b.contains(lo)) {
+                    out.array.push_back(lo);
+                }
+            }
+            out.cardinality = static_cast<uint32_t>(out.array.size());
+        }
+        return out;
+    }
+
+    static uint16_t high(uint32_t value) { return static_cast<uint16_t>(value >> 16); }
+    static uint16_t low(uint32_t value) { return static_cast<uint16_t>(value & 0xFFFF); }
+
+    std::vector<Chunk>::iterator lowerBound(uint16_t key) {
+        return std::lower_bound(chunks.begin(), chunks.end(), key,
+                                [](const Chunk& chunk, uint16_t k) { return chunk.key < k; });
+    }
+
+    const Chunk* find(uint16_t key) const {
+        auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+                                   [](const Chunk& chunk, uint16_t k) { return chunk.key < k; });
+        return (it != chunks.end() && it->key == key) ? &*it : nullptr;
+    }
+
+    Chunk& findOrInsert(uint16_t key) {
+        if (!chunks.empty() && chunks.back().key == key) {
+            return chunks.back();
+        }
+        auto it = lowerBound(key);
+        if (it == chunks.end() || it->key != key) {
+            it = chunks.insert(it, Chunk(key));
+        }
+        return *it;
+    }
+
+    std::vector<Chunk> chunks;
+};
+
+#endif // ROARING_BITMAP_H
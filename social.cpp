@@ -1,178 +1,384 @@
+/*
+Compile using [g++ -O2 -pthread social.cpp -o social]
+Build a binary snapshot (with lookalike signatures) with [./social --snapshot nodes.txt nodes.snap]
+Ingest from a pipe with [producer | ./social --stream -] or tail a FIFO/file with [./social --stream feed.txt]
+Batch targeting with [./social --target "(coder OR gamer) AND NOT weeb" ...] or one expression per line from [./social --target -]
+*/
+
 #include <iostream>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
-#include <fstream>
 #include <sstream>
-#include <memory> // For smart pointers
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+
+#include "social_network.h"
+#include "stream_ingest.h"
 
 using namespace std;
 
-class Node {
-public:
-    int id;
-    unordered_set<string> characteristics;
+void printPostMessage(SocialNetwork& network, const string& keyword) {
+    auto result = network.postMessage(keyword);
 
-    Node(int id) : id(id) {}
-};
+    // Print nodes that received the post
+    cout << "Nodes that received the post:" << endl;
+    for (const auto& entry : result) {
+        if (entry.second == "Received") {
+            cout << "Node " << entry.first << endl;
+        }
+    }
 
-class SocialNetwork {
-public:
-    void addNode(int id, const unordered_set<string>& characteristics) {
-        nodes.emplace(id, make_shared<Node>(id)); // Using smart pointer
-        nodes[id]->characteristics = characteristics;
+    // Print nodes that did not receive the post
+    cout << "\nNodes that did not receive the post:" << endl;
+    for (const auto& entry : result) {
+        if (entry.second != "Received") {
+            cout << "Node " << entry.first << endl;
+        }
     }
 
-    void addEdge(int id1, int id2) {
-        adjList[id1].insert(id2);
-        adjList[id2].insert(id1);
+    // Print reach count by characteristics
+    cout << "\nReach count by characteristics:" << endl;
+    for (const auto& pair : network.characteristicCounts()) {
+        cout << pair.first << ": " << pair.second << endl;
     }
+}
 
-    void postMessage(const string& keyword) {
-        unordered_set<int> reachedNodes;
-        unordered_set<int> notReachedNodes;
-        unordered_map<string, int> characteristicCounts;
+void printPropagation(SocialNetwork& network, const string& keyword, const vector<int>& seeds, int maxHops) {
+    propagation::Result result = network.propagatePost(seeds, keyword, maxHops);
 
-        for (const auto& pair : nodes) {
-            const Node& node = *(pair.second);
-            if (node.characteristics.count(keyword)) {
-                reachedNodes.insert(node.id);
-            } else {
-                notReachedNodes.insert(node.id);
-            }
+    cout << "\nNodes reached by the post:" << endl;
+    for (uint32_t v : result.reached) {
+        cout << "Node " << network.node(v).id() << " (hop " << result.hop[v] << ")" << endl;
+    }
 
-            // Update characteristic counts
-            for (const string& characteristic : node.characteristics) {
-                characteristicCounts[characteristic]++;
-            }
-        }
+    cout << "\nReach by hop:" << endl;
+    for (size_t h = 0; h < result.perHop.size(); ++h) {
+        cout << "Hop " << h << ": " << result.perHop[h] << endl;
+    }
+    cout << "Total reached: " << result.reached.size() << endl;
+}
 
-        // Print nodes that received the post
-        cout << "Nodes that received the post:" << endl;
-        for (int nodeId : reachedNodes) {
-            cout << "Node " << nodeId << endl;
-        }
+void printSimulation(SocialNetwork& network, const vector<int>& seeds, const diffusion::Options& options,
+                     const diffusion::EdgeProbability& probability) {
+    diffusion::Summary summary = network.simulateSpread(seeds, options, probability);
+
+    cout << "\nExpected reach over " << summary.trials << " trials: " << summary.reach.mean
+         << " (variance " << summary.reach.variance << ")" << endl;
 
-        // Print nodes that did not receive the post
-        cout << "\nNodes that did not receive the post:" << endl;
-        for (int nodeId : notReachedNodes) {
-            cout << "Node " << nodeId << endl;
+    // Expected reach by characteristics, alongside today's counts
+    cout << "\nExpected reach by characteristics:" << endl;
+    const auto& characteristics = network.getAvailableCharacteristics();
+    for (uint32_t id = 0; id < summary.byCharacteristic.size(); ++id) {
+        const diffusion::Stat& stat = summary.byCharacteristic[id];
+        if (stat.mean > 0) {
+            cout << characteristics.name(id) << ": " << stat.mean << " (variance " << stat.variance << ")" << endl;
         }
+    }
+}
+
+void printInfluencers(SocialNetwork& network, const influence::Options& options,
+                      const unordered_set<string>& targetCharacteristics, const diffusion::EdgeProbability& probability) {
+    influence::Result result = network.maximizeInfluence(options, targetCharacteristics, probability);
+
+    cout << "\nTop influencers:" << endl;
+    for (uint32_t v : result.seeds) {
+        cout << "Node " << network.node(v).id() << endl;
+    }
+    cout << "Estimated reach: " << result.spread << " from " << result.rrSets << " samples" << endl;
+    if (!result.exact) {
+        cout << "(sampling stopped at the memory limit; the estimate is looser)" << endl;
+    }
+}
+
+void printTargetAds(SocialNetwork& network, const string& expression) {
+    string error;
+    vector<int> matches = network.targetAds(expression, error);
+    if (!error.empty()) {
+        cerr << "Invalid target expression: " << error << endl;
+        return;
+    }
+    cout << "\nTargeted Ads based on Characteristics:" << endl;
+    for (int nodeId : matches) {
+        cout << "Node " << nodeId << " matches the target characteristics." << endl;
+    }
+}
+
+void printDominance(SocialNetwork& network, DominanceMode mode = DominanceMode::Degree) {
+    // Only counts are printed, so no neighbor lists are materialized
+    auto rows = network.topDominance(SIZE_MAX, {}, mode);
+
+    // Print dominance levels
+    cout << "\nDominance Levels:" << endl;
+    for (const auto& row : rows) {
+        cout << "Node " << row.id << ": " << row.degree << " connections" << endl;
+    }
 
-        // Print reach count by characteristics
-        cout << "\nReach count by characteristics:" << endl;
-        for (const auto& pair : characteristicCounts) {
-            cout << pair.first << ": " << pair.second << endl;
+    // Print influence levels by characteristics
+    cout << "\nInfluence Levels by Characteristics:" << endl;
+    for (const auto& pair : network.characteristicCounts()) {
+        cout << pair.first << ": " << pair.second << endl;
+    }
+}
+
+void printPageRank(SocialNetwork& network) {
+    printDominance(network, DominanceMode::PageRank);
+
+    // Convergence log
+    centrality::PageRankResult result = network.pageRank();
+    cout << "\nPageRank residual by iteration:" << endl;
+    for (size_t i = 0; i < result.residuals.size(); ++i) {
+        cout << "Iteration " << i + 1 << ": " << result.residuals[i] << endl;
+    }
+    cout << (result.converged ? "Converged" : "Stopped at the iteration cap") << endl;
+}
+
+void printBetweenness(SocialNetwork& network, const centrality::BetweennessOptions& options, size_t limit) {
+    centrality::BetweennessResult result = network.betweenness(options);
+    vector<uint32_t> ranked;
+    for (uint32_t v = 0; v < result.scores.size(); ++v) {
+        ranked.push_back(v);
+    }
+    limit = min(limit, ranked.size());
+    partial_sort(ranked.begin(), ranked.begin() + limit, ranked.end(),
+                 [&](uint32_t a, uint32_t b) { return result.scores[a] > result.scores[b]; });
+
+    cout << "\nBridge users by betweenness (" << (result.exact ? "exact" : "sampled") << ", " << result.sources
+         << " sources):" << endl;
+    for (size_t i = 0; i < limit; ++i) {
+        cout << "Node " << network.node(ranked[i]).id() << ": " << result.scores[ranked[i]] << endl;
+    }
+}
+
+void printCores(SocialNetwork& network) {
+    printDominance(network, DominanceMode::Coreness);
+
+    centrality::CoreResult result = network.coreDecomposition();
+    vector<size_t> perCore(result.maxCore + 1, 0);
+    for (uint32_t core : result.coreness) {
+        perCore[core]++;
+    }
+    cout << "\nNodes by coreness:" << endl;
+    for (size_t k = 0; k < perCore.size(); ++k) {
+        if (perCore[k] > 0) {
+            cout << k << "-core shell: " << perCore[k] << endl;
         }
     }
+    cout << "\nInnermost " << result.maxCore << "-core:" << endl;
+    for (uint32_t v : result.innermost) {
+        cout << "Node " << network.node(v).id() << endl;
+    }
+}
 
-    void targetAds(const unordered_set<string>& targetCharacteristics) {
-        cout << "\nTargeted Ads based on Characteristics:" << endl;
-        for (const auto& pair : nodes) {
-            const Node& node = *(pair.second);
-            bool matchesTarget = true;
-            for (const string& target : targetCharacteristics) {
-                if (node.characteristics.find(target) == node.characteristics.end()) {
-                    matchesTarget = false;
-                    break;
-                }
-            }
-            if (matchesTarget) {
-                cout << "Node " << node.id << " matches the target characteristics." << endl;
-                // You can implement code here to display or record targeted ads for this node
+void printClustering(SocialNetwork& network, size_t limit) {
+    centrality::TriangleResult result = network.triangles();
+    auto rows = network.topDominance(limit, {}, DominanceMode::Clustering);
+
+    cout << "\nDominance by clustering coefficient:" << endl;
+    for (const auto& row : rows) {
+        cout << "Node " << row.id << ": " << row.degree << " connections, " << result.triangles[row.index]
+             << " triangles, clustering " << row.score << endl;
+    }
+    cout << "\nTriangles: " << result.total << endl;
+    cout << "Transitivity: " << result.transitivity << endl;
+    cout << "Average clustering: " << result.averageClustering << endl;
+}
+
+void printReach(const vector<reach::Estimate>& estimates, double relativeError, double milliseconds) {
+    cout << "\nEstimated reach (+/- " << 200 * relativeError << "% at two standard errors, " << milliseconds
+         << " ms):" << endl;
+    for (size_t k = 0; k < estimates.size(); ++k) {
+        cout << "Within " << k << " hops: " << static_cast<uint64_t>(estimates[k].value) << " ("
+             << static_cast<uint64_t>(estimates[k].low) << " - " << static_cast<uint64_t>(estimates[k].high) << ")"
+             << endl;
+    }
+}
+
+void printLookalikes(const vector<pair<int, double>>& matches, double milliseconds) {
+    cout << "\nLookalikes (" << matches.size() << " found in " << milliseconds << " ms):" << endl;
+    for (const auto& match : matches) {
+        cout << "Node " << match.first << ": " << match.second << endl;
+    }
+}
+
+void printRecommendations(SocialNetwork& network, size_t count, const vector<int>& ids) {
+    if (ids.empty()) {
+        auto start = chrono::steady_clock::now();
+        centrality::RecommendationTable table = network.recommendAllFriends(count);
+        cout << "\nPeople you may know (all " << table.vertexCount() << " nodes in "
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s):" << endl;
+        for (uint32_t v = 0; v < table.vertexCount(); ++v) {
+            cout << "Node " << network.node(v).id() << ":";
+            for (uint64_t i = table.offsets[v]; i < table.offsets[v + 1]; ++i) {
+                cout << " " << network.node(table.vertices[i]).id() << " (" << table.scores[i] << ")";
             }
+            cout << endl;
         }
+        return;
     }
+    cout << "\nPeople you may know:" << endl;
+    for (int id : ids) {
+        auto start = chrono::steady_clock::now();
+        optional<centrality::PersonalizedResult> result = network.recommendFriends(id, count);
+        double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (!result) {
+            cout << "Node " << id << " not found" << endl;
+            continue;
+        }
+        cout << "Node " << id << " (+/- " << result->error << ", " << milliseconds << " ms):";
+        for (const auto& recommendation : result->top) {
+            cout << " " << network.node(recommendation.vertex).id() << " (" << recommendation.score << ")";
+        }
+        cout << endl;
+    }
+}
 
-     void calculateDominanceAndInfluence() {
-        vector<pair<int, int>> dominanceLevels;
-        unordered_map<string, int> characteristicInfluence;
+void printFriendCharacteristics(SocialNetwork& network, size_t top, const vector<int>& ids) {
+    neighborhood::Profile profile = network.friendCharacteristics(top);
+    const CharacteristicDictionary& dictionary = network.getAvailableCharacteristics();
 
-        for (const auto& pair : adjList) {
-            int node = pair.first;
-            int connections = pair.second.size();
-            dominanceLevels.push_back({node, connections});
+    auto printRow = [&](const NodeView& node) {
+        cout << "Node " << node.id() << ":";
+        for (const auto& entry : profile.top(node.index())) {
+            cout << " " << dictionary.name(entry.first) << " (" << entry.second << ")";
+        }
+        cout << endl;
+    };
+    cout << "\nFriends' characteristics:" << endl;
+    if (ids.empty()) {
+        network.forEachNode(printRow);
+    }
+    for (int id : ids) {
+        if (auto node = network.findNode(id)) {
+            printRow(*node);
+        } else {
+            cout << "Node " << id << " not found" << endl;
         }
+    }
+}
 
-        // Sort nodes by connection count
-        sort(dominanceLevels.begin(), dominanceLevels.end(),
-             [](const pair<int, int>& a, const pair<int, int>& b) {
-                 return a.second > b.second;
-             });
+void printIslands(SocialNetwork& network, size_t limit, size_t topCharacteristics) {
+    components::Result islands = network.connectedComponents();
+    vector<components::Histogram> histograms = network.islandCharacteristics(islands);
+    const CharacteristicDictionary& dictionary = network.getAvailableCharacteristics();
 
-        // Calculate influence levels based on characteristics
-        for (const auto& pair : nodes) {
-            const Node& node = *(pair.second);
-            for (const string& characteristic : node.characteristics) {
-                characteristicInfluence[characteristic]++;
-            }
+    size_t singletons = count(islands.sizes.begin(), islands.sizes.end(), size_t(1));
+    cout << "\n" << islands.sizes.size() << " audience islands (" << singletons << " single nodes)" << endl;
+    limit = min(limit, islands.sizes.size());
+    for (size_t c = 0; c < limit; ++c) {
+        cout << "Island " << c + 1 << ": " << islands.sizes[c] << " nodes";
+        size_t shown = min(topCharacteristics, histograms[c].size());
+        for (size_t i = 0; i < shown; ++i) {
+            cout << (i ? ", " : " - ") << dictionary.name(histograms[c][i].first) << " " << histograms[c][i].second;
         }
+        cout << endl;
+    }
+}
 
-        // Print dominance levels
-        cout << "\nDominance Levels:" << endl;
-        for (const auto& pair : dominanceLevels) {
-            cout << "Node " << pair.first << ": " << pair.second << " connections" << endl;
-        }
+void printCommunities(SocialNetwork& network, const community::Options& options, size_t limit, size_t topCharacteristics) {
+    community::Result found = network.communities(options);
+    vector<components::Histogram> histograms = network.communityCharacteristics(found);
+    const CharacteristicDictionary& dictionary = network.getAvailableCharacteristics();
 
-        // Print influence levels by characteristics
-        cout << "\nInfluence Levels by Characteristics:" << endl;
-        for (const auto& pair : characteristicInfluence) {
-            cout << pair.first << ": " << pair.second << endl;
+    cout << "\n" << found.sizes.size() << " communities" << endl;
+    for (size_t level = 0; level < found.modularity.size(); ++level) {
+        cout << "Level " << level + 1 << " modularity: " << found.modularity[level] << endl;
+    }
+    limit = min(limit, found.sizes.size());
+    for (size_t c = 0; c < limit; ++c) {
+        cout << "Community " << c + 1 << ": " << found.sizes[c] << " nodes";
+        size_t shown = min(topCharacteristics, histograms[c].size());
+        for (size_t i = 0; i < shown; ++i) {
+            cout << (i ? ", " : " - ") << dictionary.name(histograms[c][i].first) << " " << histograms[c][i].second;
         }
+        cout << endl;
     }
+}
 
-    void readFromFile(const string& filename) {
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cerr << "Error opening file: " << filename << endl;
-            return;
+int main(int argc, char* argv[]) {
+    SocialNetwork network;
+
+    // Converter: social --snapshot [nodes.txt [nodes.snap]]
+    if (argc > 1 && string(argv[1]) == "--snapshot") {
+        string textFile = argc > 2 ? argv[2] : "nodes.txt";
+        string snapshotFile = argc > 3 ? argv[3] : snapshot::pathFor(textFile);
+        if (!network.readFromFile(textFile)) {
+            return 1;
+        }
+        network.buildLookalikes();
+        if (!network.saveSnapshot(snapshotFile)) {
+            return 1;
         }
+        cout << "Wrote " << snapshotFile << endl;
+        return 0;
+    }
 
-        string line;
-        bool readingNodes = true;
-        int lineNumber = 0; // Track line number for debugging
-        while (getline(file, line)) {
-            lineNumber++; // Increment line number
-            if (line == "edges") {
-                readingNodes = false;
-                continue;
-            }
+    // Read from the snapshot if it is up to date, otherwise from the text file
+    network.load("nodes.txt");
 
-            istringstream iss(line);
-            if (readingNodes) {
-                int id;
-                if (!(iss >> id)) {
-                    cerr << "Error reading node ID at line " << lineNumber << endl;
-                    continue;
-                }
-                unordered_set<string> characteristics;
-                string characteristic;
-                while (iss >> characteristic) {
-                    characteristics.insert(characteristic);
+    // Batch targeting: social --target <expression>... prints the plan and
+    // the matching node IDs for each expression; "-" reads one expression
+    // per line from stdin.
+    if (argc > 2 && string(argv[1]) == "--target") {
+        vector<string> expressions;
+        for (int i = 2; i < argc; ++i) {
+            if (string(argv[i]) == "-") {
+                string line;
+                while (getline(cin, line)) {
+                    expressions.push_back(line);
                 }
-                addNode(id, characteristics);
             } else {
-                int id1, id2;
-                if (!(iss >> id1 >> id2)) {
-                    cerr << "Error reading edge at line " << lineNumber << endl;
-                    continue;
-                }
-                addEdge(id1, id2);
+                expressions.push_back(argv[i]);
+            }
+        }
+        bool ok = true;
+        for (const string& expression : expressions) {
+            string error;
+            optional<TargetQuery> query = network.compileTarget(expression, error);
+            if (!query) {
+                cerr << "Invalid target expression \"" << expression << "\": " << error << endl;
+                ok = false;
+                continue;
+            }
+            vector<int> matches = network.targetAds(*query);
+            cout << "# " << expression << " -> " << query->explain(network.getAvailableCharacteristics()) << ": "
+                 << matches.size() << " matches" << endl;
+            for (int nodeId : matches) {
+                cout << nodeId << endl;
             }
         }
+        return ok ? 0 : 1;
     }
 
-private:
-    unordered_map<int, shared_ptr<Node>> nodes; // Smart pointer
-    unordered_map<int, unordered_set<int>> adjList;
-};
-
-int main() {
-    SocialNetwork network;
+    // Streaming: social --stream <source>. With "-" the records come from
+    // stdin, so there is no menu; ingest until EOF and report. Otherwise the
+    // FIFO or file is tailed in the background while the menu runs.
+    bool streaming = argc > 2 && string(argv[1]) == "--stream";
+    string source = streaming ? argv[2] : "";
+    StreamIngest::Options options;
+    options.reportProgress = source == "-"; // keep stderr quiet under the menu
+    shared_mutex networkLock;
+    StreamIngest stream(network, networkLock, options);
+    if (streaming) {
+        if (source == "-") {
+            if (!stream.runToEnd(source)) {
+                return 1;
+            }
+            cout << "Graph now has " << network.nodeCount() << " nodes" << endl;
+            return 0;
+        }
+        if (!stream.start(source)) {
+            return 1;
+        }
+    }
 
-    // Read from file
-    network.readFromFile("nodes.txt");
+    // Reach sketches are built on first use and rebuilt when more hops are
+    // asked for or the stream has applied records since.
+    optional<reach::Sketch> reachSketch;
+    uint64_t reachSketchRecords = 0;
 
     // Menu driven program
     bool exitProgram = false;
@@ -183,39 +389,342 @@ int main() {
         cout << "2. Target Ads based on Characteristics\n";
         cout << "3. Exit program\n";
         cout << "4. Dominance\n";
+        cout << "5. Propagate post through friendships\n";
+        cout << "6. Simulate spread (Monte Carlo)\n";
+        cout << "7. Top influencers (influence maximization)\n";
+        cout << "8. Dominance by PageRank\n";
+        cout << "9. Bridge users (betweenness)\n";
+        cout << "10. Dominance by k-core\n";
+        cout << "11. Audience islands (connected components)\n";
+        cout << "12. Interest communities (Louvain)\n";
+        cout << "13. Dominance by clustering coefficient\n";
+        cout << "14. Reach estimate (HyperANF)\n";
+        cout << "15. Friends' characteristics\n";
+        cout << "16. Lookalike audience (MinHash)\n";
+        cout << "17. People you may know (personalized PageRank)\n";
+        if (streaming) {
+            cout << "0. Stream status\n";
+        }
         cout << "Enter your choice: ";
-        cin >> choice;
+        if (!(cin >> choice)) {
+            break;
+        }
 
         switch (choice) {
             case 1: {
                 string keyword;
                 cout << "Enter the keyword: ";
                 cin >> keyword;
-                network.postMessage(keyword);
+                // Queries see the graph as of the last applied stream batch
+                shared_lock<shared_mutex> reader(networkLock);
+                printPostMessage(network, keyword);
                 break;
             }
 
             case 2: {
-                cout << "Enter target characteristics separated by spaces: ";
+                cout << "Enter target characteristics separated by spaces, or an expression such as "
+                        "(coder OR gamer) AND NOT weeb: ";
+                string expression;
+                getline(cin >> ws, expression);
+                shared_lock<shared_mutex> reader(networkLock);
+                printTargetAds(network, expression);
+                break;
+            }
+
+            case 3: {
+                exitProgram = true;
+                break;
+            }
+
+            case 4: {
+                shared_lock<shared_mutex> reader(networkLock);
+                printDominance(network);
+                break;
+            }
+
+            case 5: {
+                string keyword;
+                cout << "Enter the keyword: ";
+                cin >> keyword;
+                cout << "Enter seed node IDs separated by spaces: ";
+                string seedsStr;
+                getline(cin >> ws, seedsStr);
+                istringstream iss(seedsStr);
+                vector<int> seeds;
+                int seed;
+                while (iss >> seed) {
+                    seeds.push_back(seed);
+                }
+                int maxHops;
+                cout << "Enter the hop limit (-1 for none): ";
+                if (!(cin >> maxHops)) {
+                    break;
+                }
+                shared_lock<shared_mutex> reader(networkLock);
+                printPropagation(network, keyword, seeds, maxHops);
+                break;
+            }
+
+            case 6: {
+                cout << "Enter seed node IDs separated by spaces: ";
+                string seedsStr;
+                getline(cin >> ws, seedsStr);
+                istringstream iss(seedsStr);
+                vector<int> seeds;
+                int seed;
+                while (iss >> seed) {
+                    seeds.push_back(seed);
+                }
+                string model;
+                diffusion::Options options;
+                diffusion::EdgeProbability probability;
+                cout << "Enter the model (ic or lt), trials, edge probability and bonus per shared characteristic: ";
+                if (!(cin >> model >> options.trials >> probability.base >> probability.perSharedCharacteristic)) {
+                    break;
+                }
+                options.model = model == "lt" ? diffusion::Model::LinearThreshold : diffusion::Model::IndependentCascade;
+                shared_lock<shared_mutex> reader(networkLock);
+                printSimulation(network, seeds, options, probability);
+                break;
+            }
+
+            case 7: {
+                influence::Options options;
+                diffusion::EdgeProbability probability;
+                cout << "Enter k, epsilon and edge probability (0 for weighted cascade): ";
+                if (!(cin >> options.k >> options.epsilon >> probability.base)) {
+                    break;
+                }
+                if (probability.base <= 0) {
+                    probability.base = 1;
+                    probability.weightedCascade = true;
+                }
+                cout << "Enter target characteristics separated by spaces (or all): ";
                 string characteristicsStr;
                 getline(cin >> ws, characteristicsStr);
                 istringstream iss(characteristicsStr);
                 unordered_set<string> targetCharacteristics;
                 string characteristic;
                 while (iss >> characteristic) {
-                    targetCharacteristics.insert(characteristic);
+                    if (characteristic != "all") {
+                        targetCharacteristics.insert(characteristic);
+                    }
                 }
-                network.targetAds(targetCharacteristics);
+                shared_lock<shared_mutex> reader(networkLock);
+                printInfluencers(network, options, targetCharacteristics, probability);
                 break;
             }
 
-            case 3: {
-                exitProgram = true;
+            case 8: {
+                shared_lock<shared_mutex> reader(networkLock);
+                printPageRank(network);
                 break;
             }
 
-            case 4: {
-                network.calculateDominanceAndInfluence();
+            case 9: {
+                centrality::BetweennessOptions options;
+                size_t limit;
+                cout << "Enter the number of sampled sources (0 for exact) and how many nodes to list: ";
+                if (!(cin >> options.samples >> limit)) {
+                    break;
+                }
+                shared_lock<shared_mutex> reader(networkLock);
+                printBetweenness(network, options, limit);
+                break;
+            }
+
+            case 10: {
+                shared_lock<shared_mutex> reader(networkLock);
+                printCores(network);
+                break;
+            }
+
+            case 11: {
+                size_t limit, topCharacteristics;
+                cout << "Enter how many islands to list and characteristics per island: ";
+                if (!(cin >> limit >> topCharacteristics)) {
+                    break;
+                }
+                shared_lock<shared_mutex> reader(networkLock);
+                printIslands(network, limit, topCharacteristics);
+                break;
+            }
+
+            case 12: {
+                community::Options options;
+                size_t limit, topCharacteristics;
+                cout << "Enter the resolution (1 is standard modularity), how many communities to list and "
+                        "characteristics per community: ";
+                if (!(cin >> options.resolution >> limit >> topCharacteristics)) {
+                    break;
+                }
+                shared_lock<shared_mutex> reader(networkLock);
+                printCommunities(network, options, limit, topCharacteristics);
+                break;
+            }
+
+            case 13: {
+                size_t limit;
+                cout << "Enter how many nodes to list: ";
+                if (!(cin >> limit)) {
+                    break;
+                }
+                shared_lock<shared_mutex> reader(networkLock);
+                printClustering(network, limit);
+                break;
+            }
+
+            case 14: {
+                reach::Options options;
+                string segment;
+                long long hops;
+                cout << "Enter the hop limit: ";
+                if (!(cin >> hops)) {
+                    break;
+                }
+                if (hops < 0 || hops > static_cast<long long>(reach::kMaxHops)) {
+                    cerr << "Hop limit must be between 0 and " << reach::kMaxHops << endl;
+                    break;
+                }
+                options.hops = static_cast<size_t>(hops);
+                cout << "Enter the segment as a target expression, or # followed by node IDs: ";
+                getline(cin >> ws, segment);
+                shared_lock<shared_mutex> reader(networkLock);
+                uint64_t records = streaming ? stream.stats().records : 0;
+                if (!reachSketch || reachSketch->hops() < options.hops || records != reachSketchRecords) {
+                    auto start = chrono::steady_clock::now();
+                    reachSketch = network.reachSketch(options);
+                    reachSketchRecords = records;
+                    cout << "Built reach sketches in "
+                         << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s ("
+                         << reachSketch->memoryBytes() / (1 << 20) << " MiB)" << endl;
+                }
+
+                auto start = chrono::steady_clock::now();
+                vector<reach::Estimate> estimates;
+                if (!segment.empty() && segment[0] == '#') {
+                    istringstream iss(segment.substr(1));
+                    vector<int> ids;
+                    int id;
+                    while (iss >> id) {
+                        ids.push_back(id);
+                    }
+                    estimates = network.estimateReach(*reachSketch, ids);
+                } else {
+                    string error;
+                    optional<TargetQuery> query = network.compileTarget(segment, error);
+                    if (!query) {
+                        cerr << "Invalid target expression: " << error << endl;
+                        break;
+                    }
+                    estimates = network.estimateReach(*reachSketch, *query);
+                }
+                estimates.resize(options.hops + 1);
+                printReach(estimates, reachSketch->relativeError(),
+                           chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+                break;
+            }
+
+            case 15: {
+                size_t top;
+                string line;
+                cout << "Enter how many characteristics per node: ";
+                if (!(cin >> top)) {
+                    break;
+                }
+                cout << "Enter node IDs, or all: ";
+                getline(cin >> ws, line);
+                vector<int> ids;
+                if (line != "all") {
+                    istringstream iss(line);
+                    int id;
+                    while (iss >> id) {
+                        ids.push_back(id);
+                    }
+                }
+                shared_lock<shared_mutex> reader(networkLock);
+                printFriendCharacteristics(network, top, ids);
+                break;
+            }
+
+            case 16: {
+                size_t count;
+                string seeds;
+                cout << "Enter how many lookalikes to show: ";
+                if (!(cin >> count)) {
+                    break;
+                }
+                cout << "Enter the seed audience as a target expression, or # followed by node IDs: ";
+                getline(cin >> ws, seeds);
+                {
+                    // Signatures come from the snapshot, or are built once
+                    // here; stream updates drop them.
+                    unique_lock<shared_mutex> writer(networkLock);
+                    if (!network.hasLookalikes()) {
+                        auto start = chrono::steady_clock::now();
+                        network.buildLookalikes();
+                        cout << "Built lookalike signatures in "
+                             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+                    }
+                }
+
+                shared_lock<shared_mutex> reader(networkLock);
+                auto start = chrono::steady_clock::now();
+                vector<pair<int, double>> matches;
+                if (!seeds.empty() && seeds[0] == '#') {
+                    istringstream iss(seeds.substr(1));
+                    vector<int> ids;
+                    int id;
+                    while (iss >> id) {
+                        ids.push_back(id);
+                    }
+                    matches = network.findLookalikes(ids, count);
+                } else {
+                    string error;
+                    optional<TargetQuery> query = network.compileTarget(seeds, error);
+                    if (!query) {
+                        cerr << "Invalid target expression: " << error << endl;
+                        break;
+                    }
+                    matches = network.findLookalikes(*query, count);
+                }
+                printLookalikes(matches, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+                break;
+            }
+
+            case 17: {
+                size_t count;
+                string line;
+                cout << "Enter how many recommendations per node: ";
+                if (!(cin >> count)) {
+                    break;
+                }
+                cout << "Enter node IDs, or all: ";
+                getline(cin >> ws, line);
+                vector<int> ids;
+                if (line != "all") {
+                    istringstream iss(line);
+                    int id;
+                    while (iss >> id) {
+                        ids.push_back(id);
+                    }
+                }
+                shared_lock<shared_mutex> reader(networkLock);
+                printRecommendations(network, count, ids);
+                break;
+            }
+
+            case 0: {
+                if (streaming) {
+                    shared_lock<shared_mutex> reader(networkLock);
+                    IngestStats stats = stream.stats();
+                    cout << "Ingested " << stats.records << " records (" << stats.nodes << " nodes, " << stats.edges
+                         << " edges, " << stats.errors << " errors) in " << stats.batches << " batches, "
+                         << static_cast<uint64_t>(stats.recordsPerSecond()) << " records/s" << endl;
+                    cout << "Graph has " << network.nodeCount() << " nodes" << endl;
+                    break;
+                }
+                cout << "Invalid choice. Please try again.\n";
                 break;
             }
 
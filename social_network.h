@@ -0,0 +1,859 @@
+#ifndef SOCIAL_NETWORK_H
+#define SOCIAL_NETWORK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "betweenness.h"
+#include "characteristic_dictionary.h"
+#include "community.h"
+#include "components.h"
+#include "csr_graph.h"
+#include "diffusion.h"
+#include "edge_ingest.h"
+#include "graph_snapshot.h"
+#include "kcore.h"
+#include "influence_max.h"
+#include "lookalike.h"
+#include "mapped_file.h"
+#include "neighbor_histogram.h"
+#include "node_index.h"
+#include "node_store.h"
+#include "pagerank.h"
+#include "parallel.h"
+#include "personalized_pagerank.h"
+#include "posting_index.h"
+#include "propagation.h"
+#include "reach_sketch.h"
+#include "target_query.h"
+#include "triangles.h"
+
+// Ranking used by calculateDominanceAndInfluence.
+enum class DominanceMode {
+    Degree,   // number of connections
+    PageRank, // centrality::pageRank score
+    Betweenness, // centrality::betweenness, sampled on large graphs
+    Coreness, // k-core number, ties broken by degree
+    Clustering, // local clustering coefficient from centrality::triangles
+};
+
+// One ranked dominance row. Carries no neighbor copy: the dense index lets
+// the caller span the adjacency only for rows it displays.
+struct DominanceRow {
+    int id;
+    uint32_t index;
+    size_t degree;
+    double score;
+};
+
+class SocialNetwork {
+public:
+    void addNode(int id, const std::unordered_set<std::string>& characteristics) {
+        std::vector<std::string_view> views(characteristics.begin(), characteristics.end());
+        addNode(id, views);
+    }
+
+    // Loader overload: takes views into the mapped file. Each name is interned
+    // and the node keeps only the sorted, deduplicated IDs. Repeating a node
+    // line unchanged is a no-op, so it keeps the lookalike index.
+    void addNode(int id, const std::vector<std::string_view>& characteristics) {
+        uint32_t v = vertex(id);
+        scratchIds.clear();
+        for (std::string_view characteristic : characteristics) {
+            scratchIds.push_back(dictionary.intern(characteristic));
+        }
+        sortUnique(scratchIds);
+
+        const uint32_t* after = scratchIds.data();
+        const uint32_t* afterEnd = after + scratchIds.size();
+        if (!nodes.isDeclared(v)) {
+            nodes.set(v, scratchIds);
+            postings.update(v, nullptr, nullptr, after, afterEnd);
+        } else if (std::equal(nodes.charBegin(v), nodes.charEnd(v), after, afterEnd)) {
+            return;
+        } else {
+            // set() may compact the pool, so the old run is copied first.
+            std::vector<uint32_t> before(nodes.charBegin(v), nodes.charEnd(v));
+            nodes.set(v, scratchIds);
+            postings.update(v, before.data(), before.data() + before.size(), after, afterEnd);
+        }
+        if (!lookalikes.empty()) {
+            lookalikes = lookalike::Index();
+        }
+    }
+
+    void addEdge(int id1, int id2) {
+        uint32_t v1 = vertex(id1);
+        uint32_t v2 = vertex(id2);
+        adjList.addEdge(v1, v2);
+        lookalikes = lookalike::Index();
+    }
+
+    // Folds edges from addEdge and addEdges into the frozen rows. Writers call
+    // this under the same exclusive lock after a bulk load or once a stream
+    // goes quiet, so the analytics read adjList in place instead of merging a
+    // copy per query. addEdge folds on its own once the delta grows.
+    void flushEdges() {
+        adjList.freeze(index.size());
+    }
+
+    bool hasPendingEdges() const { return adjList.hasPending(); }
+
+    // Bulk insert of parsed edge buffers: everything is staged, and the
+    // caller's next flushEdges folds it into the CSR in one merge instead of
+    // one incremental insert per edge. Endpoints are translated to dense
+    // indexes per chunk in parallel; only IDs that never had a node line need
+    // the serial intern pass.
+    void addEdges(const std::vector<ingest::EdgeChunk>& chunks) {
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> dense(chunks.size());
+        std::vector<std::vector<size_t>> misses(chunks.size());
+        parallel::forBlocks(chunks.size(), [&](size_t begin, size_t end, unsigned) {
+            for (size_t c = begin; c < end; ++c) {
+                dense[c].reserve(chunks[c].edges.size());
+                for (const auto& edge : chunks[c].edges) {
+                    uint32_t v1 = index.find(edge.first);
+                    uint32_t v2 = index.find(edge.second);
+                    if (v1 == NodeIndex::kMissing || v2 == NodeIndex::kMissing) {
+                        misses[c].push_back(dense[c].size());
+                    }
+                    dense[c].emplace_back(v1, v2);
+                }
+            }
+        }, 1);
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            for (size_t i : misses[c]) {
+                dense[c][i] = {index.intern(chunks[c].edges[i].first), index.intern(chunks[c].edges[i].second)};
+            }
+            adjList.stageEdges(dense[c]);
+            dense[c] = {};
+        }
+        nodes.resize(index.size());
+        adjList.addRows(index.size());
+        lookalikes = lookalike::Index();
+    }
+
+    std::vector<std::pair<int, std::string>> postMessage(const std::string& keyword) {
+        std::vector<std::pair<int, std::string>> result;
+        uint32_t keywordId = dictionary.find(keyword);
+
+        // Receivers are the keyword's set; everyone else is declared ANDNOT it.
+        const RoaringBitmap& reachedNodes = postings.list(keywordId);
+        RoaringBitmap notReachedNodes = RoaringBitmap::andNotOf(postings.declared(), reachedNodes);
+
+        result.reserve(nodes.declaredCount());
+        reachedNodes.forEach([&](uint32_t v) { result.push_back({index.externalId(v), "Received"}); });
+        notReachedNodes.forEach([&](uint32_t v) { result.push_back({index.externalId(v), "Not Received"}); });
+
+        return result;
+    }
+
+    // Multi-hop post: starts at the seed nodes and spreads along friendships to
+    // nodes that hold `keyword`, for at most maxHops hops (negative: no limit).
+    // Unknown seed IDs are ignored.
+    propagation::Result propagatePost(const std::vector<int>& seedIds, const std::string& keyword,
+                                      int maxHops = -1) const {
+        uint32_t keywordId = dictionary.find(keyword);
+        return propagate(seedIds, [&](const NodeView& node) { return node.has(keywordId); }, maxHops);
+    }
+
+    // Same spread with any acceptance rule over the receiving node; only
+    // declared nodes are offered to accept().
+    template <typename Accept>
+    propagation::Result propagate(const std::vector<int>& seedIds, Accept accept, int maxHops = -1) const {
+        return propagation::spread(adjList, index.size(), denseIds(seedIds), [&](uint32_t v) {
+            return nodes.isDeclared(v) && accept(node(v));
+        }, maxHops);
+    }
+
+    // postMessage with propagation: declared nodes as "Received at hop N" in
+    // the order reached, then the rest as "Not Received".
+    std::vector<std::pair<int, std::string>> postMessage(const std::string& keyword, const std::vector<int>& seedIds,
+                                                         int maxHops = -1) const {
+        propagation::Result spread = propagatePost(seedIds, keyword, maxHops);
+        std::vector<std::pair<int, std::string>> result;
+        result.reserve(nodes.declaredCount());
+        for (uint32_t v : spread.reached) {
+            if (nodes.isDeclared(v)) {
+                result.push_back({index.externalId(v), "Received at hop " + std::to_string(spread.hop[v])});
+            }
+        }
+        postings.declared().forEach([&](uint32_t v) {
+            if (spread.hop[v] == propagation::kUnreached) {
+                result.push_back({index.externalId(v), "Not Received"});
+            }
+        });
+        return result;
+    }
+
+    // Monte Carlo reach from the seed nodes under IC or LT, with edge
+    // probabilities from `probability`: base plus a bonus per characteristic
+    // the two endpoints share. Per-characteristic stats are indexed by
+    // dictionary ID.
+    diffusion::Summary simulateSpread(const std::vector<int>& seedIds, const diffusion::Options& options,
+                                      const diffusion::EdgeProbability& probability = {}) const {
+        return simulateSpread(seedIds, options, SharedCharacteristicRule{probability, &adjList});
+    }
+
+    // Same, with any probability(from, to) rule for the edge from -> to.
+    template <typename Probability>
+    diffusion::Summary simulateSpread(const std::vector<int>& seedIds, const diffusion::Options& options,
+                                      Probability probability) const {
+        CsrGraph scratch;
+        const CsrGraph& graph = frozenGraph(scratch);
+        std::vector<float> weights;
+        edgeWeights(graph, probability, false, weights);
+
+        // LT scales each vertex's incoming weights to sum to at most 1.
+        std::vector<double> inWeight(graph.rowCount(), 1.0);
+        if (options.model == diffusion::Model::LinearThreshold) {
+            std::vector<float> incoming;
+            edgeWeights(graph, probability, true, incoming);
+            for (uint32_t v = 0; v < graph.rowCount(); ++v) {
+                double total = 0;
+                for (uint64_t e = graph.rowOffsets()[v]; e < graph.rowOffsets()[v + 1]; ++e) {
+                    total += incoming[e];
+                }
+                inWeight[v] = std::max(1.0, total);
+            }
+        }
+        return diffusion::simulate(graph, weights, inWeight, denseIds(seedIds), dictionary.size(), [&](uint32_t v) {
+            return std::make_pair(nodes.charBegin(v), nodes.charEnd(v));
+        }, options);
+    }
+
+    // Best options.k seeds for an IC campaign (IMM). With targets, the
+    // audience is the nodes holding all of them and the spread counts only
+    // those; otherwise every vertex counts.
+    influence::Result maximizeInfluence(const influence::Options& options,
+                                        const std::unordered_set<std::string>& targetCharacteristics = {},
+                                        const diffusion::EdgeProbability& probability = {}) const {
+        std::vector<uint32_t> targets;
+        if (!resolve(targetCharacteristics, targets)) {
+            return influence::Result();
+        }
+        CsrGraph scratch;
+        const CsrGraph& graph = frozenGraph(scratch);
+        std::vector<float> weights;
+        edgeWeights(graph, SharedCharacteristicRule{probability, &graph}, true, weights);
+        std::vector<uint32_t> audience;
+        if (targets.empty()) {
+            audience.resize(graph.rowCount());
+            for (uint32_t v = 0; v < audience.size(); ++v) {
+                audience[v] = v;
+            }
+        } else {
+            audience = postings.intersect(targets).toVector();
+        }
+        return influence::maximize(graph, weights, audience, options);
+    }
+
+    std::vector<int> targetAds(const std::unordered_set<std::string>& targetCharacteristics) {
+        std::vector<int> result;
+        std::vector<uint32_t> targets;
+        if (!resolve(targetCharacteristics, targets)) {
+            return result;
+        }
+        postings.intersect(targets).forEach([&](uint32_t v) { result.push_back(index.externalId(v)); });
+        return result;
+    }
+
+    // Plan for a targeting expression such as "(coder OR gamer) AND NOT weeb"
+    // (see target_query.h), ordered by the current posting sizes; nullopt
+    // with `error` set if it does not parse.
+    std::optional<TargetQuery> compileTarget(std::string_view expression, std::string& error) const {
+        return TargetQuery::compile(expression, dictionary, postings, error);
+    }
+
+    std::vector<int> targetAds(const TargetQuery& query) const {
+        std::vector<int> result;
+        query.run(postings).forEach([&](uint32_t v) { result.push_back(index.externalId(v)); });
+        return result;
+    }
+
+    // Entry point shared by the CLI menu, the GUI and `social --target`:
+    // matching node IDs in dense order, or nothing with `error` set.
+    std::vector<int> targetAds(std::string_view expression, std::string& error) const {
+        std::optional<TargetQuery> query = compileTarget(expression, error);
+        return query ? targetAds(*query) : std::vector<int>();
+    }
+
+    // The k best rows under `mode`, best first (ties in dense order); nodes
+    // without connections are skipped and targets restrict the candidates.
+    // Each worker keeps a bounded heap of k rows, so memory and copying stay
+    // O(k) per worker; neighbors(row.index) spans the adjacency for the rows
+    // that are actually shown.
+    std::vector<DominanceRow> topDominance(size_t k, const std::unordered_set<std::string>& targetCharacteristics = {},
+                                           DominanceMode mode = DominanceMode::Degree) const {
+        std::vector<DominanceRow> rows;
+        std::vector<uint32_t> targets;
+        if (k == 0 || !resolve(targetCharacteristics, targets)) {
+            return rows;
+        }
+        std::vector<double> scores = dominanceScores(mode);
+        std::vector<uint32_t> audience;
+        if (!targets.empty()) {
+            audience = postings.intersect(targets).toVector();
+        }
+        size_t count = targets.empty() ? index.size() : audience.size();
+
+        // As a heap comparator this keeps the worst kept row at the front.
+        auto better = [](const DominanceRow& a, const DominanceRow& b) {
+            return a.score > b.score || (a.score == b.score && a.index < b.index);
+        };
+        std::vector<std::vector<DominanceRow>> heaps(parallel::blockCount(count));
+        parallel::forBlocks(count, [&](size_t begin, size_t end, unsigned worker) {
+            std::vector<DominanceRow>& heap = heaps[worker];
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t v = targets.empty() ? static_cast<uint32_t>(i) : audience[i];
+                size_t degree = adjList.degree(v);
+                if (degree == 0) {
+                    continue;
+                }
+                DominanceRow row{index.externalId(v), v, degree, scores.empty() ? double(degree) : scores[v]};
+                if (heap.size() < k) {
+                    heap.push_back(row);
+                    std::push_heap(heap.begin(), heap.end(), better);
+                } else if (better(row, heap.front())) {
+                    std::pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = row;
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+            }
+        });
+        for (const auto& heap : heaps) {
+            rows.insert(rows.end(), heap.begin(), heap.end());
+        }
+        std::sort(rows.begin(), rows.end(), better);
+        if (rows.size() > k) {
+            rows.resize(k);
+        }
+        return rows;
+    }
+
+    // Full ranking with every neighbor list spelled out; prefer topDominance
+    // and neighbors() when only the first rows are displayed.
+    std::pair<std::vector<std::pair<int, std::vector<int>>>, std::pair<int, int>>
+    calculateDominanceAndInfluence(const std::unordered_set<std::string>& targetCharacteristics = {},
+                                   DominanceMode mode = DominanceMode::Degree) {
+        std::vector<std::pair<int, std::vector<int>>> dominanceLevels;
+        for (const DominanceRow& row : topDominance(index.size(), targetCharacteristics, mode)) {
+            std::vector<int> connections;
+            connections.reserve(row.degree);
+            for (uint32_t neighbor : adjList.neighbors(row.index)) {
+                connections.push_back(index.externalId(neighbor));
+            }
+            dominanceLevels.push_back({row.id, std::move(connections)});
+        }
+
+        int topDominator = dominanceLevels.empty() ? -1 : dominanceLevels.front().first;
+        int topInfluencer = dominanceLevels.empty() ? -1 : topInfluencerFor(targetCharacteristics);
+        return {dominanceLevels, {topDominator, topInfluencer}};
+    }
+
+    // The single best IMM seed (weighted cascade) for the audience, not the
+    // highest degree again; -1 if there is none.
+    int topInfluencerFor(const std::unordered_set<std::string>& targetCharacteristics = {}) const {
+        diffusion::EdgeProbability weightedCascade;
+        weightedCascade.base = 1;
+        weightedCascade.weightedCascade = true;
+        influence::Result best = maximizeInfluence(influence::Options(), targetCharacteristics, weightedCascade);
+        return best.seeds.empty() ? -1 : index.externalId(best.seeds.front());
+    }
+
+    NeighborSpan neighbors(uint32_t v) const { return adjList.neighbors(v); }
+
+    // PageRank over the whole friendship graph; scores are indexed by dense
+    // vertex (see node(v)) and residuals has one entry per iteration.
+    centrality::PageRankResult pageRank(const centrality::PageRankOptions& options = {}) const {
+        CsrGraph scratch;
+        return centrality::pageRank(frozenGraph(scratch), options);
+    }
+
+    // Brandes betweenness over the whole friendship graph, exact or from
+    // sampled sources; scores are indexed by dense vertex.
+    centrality::BetweennessResult betweenness(const centrality::BetweennessOptions& options = {}) const {
+        CsrGraph scratch;
+        return centrality::betweenness(frozenGraph(scratch), options);
+    }
+
+    // Coreness of every dense vertex and the innermost (max-k) core.
+    centrality::CoreResult coreDecomposition() const {
+        CsrGraph scratch;
+        return centrality::coreDecompositionAuto(frozenGraph(scratch));
+    }
+
+    // Connected components ("audience islands") of the friendship graph over
+    // every dense vertex; component 0 is the largest and nodes without
+    // friends are islands of one.
+    components::Result connectedComponents() const {
+        CsrGraph scratch;
+        return components::connected(frozenGraph(scratch));
+    }
+
+    // For each component of `islands`, how many of its nodes hold each
+    // characteristic, as dictionary IDs sorted by count.
+    std::vector<components::Histogram> islandCharacteristics(const components::Result& islands) const {
+        return components::histograms(islands.component, islands.sizes.size(), [&](uint32_t v) {
+            return std::make_pair(nodes.charBegin(v), nodes.charEnd(v));
+        });
+    }
+
+    // Louvain communities of the friendship graph over every dense vertex;
+    // community 0 is the largest.
+    community::Result communities(const community::Options& options = {}) const {
+        CsrGraph scratch;
+        return community::louvain(frozenGraph(scratch), options);
+    }
+
+    // Dominant characteristics of each community in `found`, as dictionary
+    // IDs sorted by how many members hold them.
+    std::vector<components::Histogram> communityCharacteristics(const community::Result& found) const {
+        return components::histograms(found.community, found.sizes.size(), [&](uint32_t v) {
+            return std::make_pair(nodes.charBegin(v), nodes.charEnd(v));
+        });
+    }
+
+    // Triangles through every dense vertex, local clustering coefficients and
+    // the global counts.
+    centrality::TriangleResult triangles() const {
+        CsrGraph scratch;
+        return centrality::triangles(frozenGraph(scratch));
+    }
+
+    // HyperANF sketches of every vertex's 0..hops neighborhoods, as of this
+    // call. Build once; estimateReach then answers per segment without a
+    // traversal.
+    reach::Sketch reachSketch(const reach::Options& options = {}) const {
+        CsrGraph scratch;
+        return reach::Sketch::build(frozenGraph(scratch), options);
+    }
+
+    // Approximate number of nodes within k hops of a segment, k = 0..hops,
+    // with two-standard-error bounds.
+    std::vector<reach::Estimate> estimateReach(const reach::Sketch& sketch, const TargetQuery& segment) const {
+        return sketch.estimate(segment.run(postings).toVector());
+    }
+
+    std::vector<reach::Estimate> estimateReach(const reach::Sketch& sketch, const std::vector<int>& ids) const {
+        return sketch.estimate(denseIds(ids));
+    }
+
+    // For every dense vertex, the `top` characteristics most common among
+    // its friends with how many friends hold each ("your friends like X").
+    neighborhood::Profile friendCharacteristics(size_t top) const {
+        CsrGraph scratch;
+        return neighborhood::topCharacteristics(frozenGraph(scratch), dictionary.size(), [&](uint32_t v) {
+            return std::make_pair(nodes.charBegin(v), nodes.charEnd(v));
+        }, top);
+    }
+
+    // "People you may know": the k non-friends with the highest personalized
+    // PageRank from node `id`, by dense index; nullopt for an unknown ID.
+    // Readers run this concurrently under a shared lock, so each thread keeps
+    // its own workspace and a query costs what it explores rather than an
+    // O(n) allocation.
+    std::optional<centrality::PersonalizedResult> recommendFriends(
+        int id, size_t k, const centrality::PersonalizedOptions& options = {}) const {
+        uint32_t v = index.find(id);
+        if (v == NodeIndex::kMissing) {
+            return std::nullopt;
+        }
+        thread_local centrality::detail::PersonalizedWorkspace workspace;
+        CsrGraph scratch;
+        return centrality::personalizedPageRank(frozenGraph(scratch), v, k, options, workspace);
+    }
+
+    // The same for every dense vertex at once, in parallel.
+    centrality::RecommendationTable recommendAllFriends(size_t k,
+                                                        const centrality::PersonalizedOptions& options = {}) const {
+        CsrGraph scratch;
+        return centrality::recommendAll(frozenGraph(scratch), k, options);
+    }
+
+    // MinHash signatures over every vertex's characteristics and friends,
+    // banded for lookalike queries. Kept with the network and written to
+    // snapshots; any node or edge change drops them.
+    void buildLookalikes(const lookalike::Options& options = {}) {
+        CsrGraph scratch;
+        lookalikes = lookalike::Index::build(frozenGraph(scratch), [&](uint32_t v) {
+            return std::make_pair(nodes.charBegin(v), nodes.charEnd(v));
+        }, [&](uint32_t v) { return nodes.isDeclared(v); }, options);
+    }
+
+    bool hasLookalikes() const { return !lookalikes.empty(); }
+
+    // The k declared nodes most similar to any seed (seeds excluded), with
+    // the estimated Jaccard similarity. Empty until buildLookalikes.
+    std::vector<std::pair<int, double>> findLookalikes(const std::vector<int>& seedIds, size_t k) const {
+        return lookalikeMatches(denseIds(seedIds), k);
+    }
+
+    // Same, seeded with a targeting segment such as the one targetAds shows.
+    std::vector<std::pair<int, double>> findLookalikes(const TargetQuery& segment, size_t k) const {
+        return lookalikeMatches(segment.run(postings).toVector(), k);
+    }
+
+    // Number of nodes holding each characteristic.
+    std::unordered_map<std::string, int> characteristicCounts() const {
+        std::vector<int> byId(dictionary.size(), 0);
+        forEachNode([&](const NodeView& node) {
+            for (uint32_t characteristic : node) {
+                byId[characteristic]++;
+            }
+        });
+        std::unordered_map<std::string, int> counts;
+        for (uint32_t id = 0; id < byId.size(); ++id) {
+            if (byId[id] > 0) {
+                counts[dictionary.name(id)] = byId[id];
+            }
+        }
+        return counts;
+    }
+
+    // Text format: one "id characteristic..." line per node, then a line reading
+    // "edges", then one "id1 id2" line per friendship. The file is mapped and
+    // scanned in place; malformed lines are reported and skipped.
+    bool readFromFile(const std::string& filename) {
+        MappedFile file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Error opening file: " << filename << std::endl;
+            return false;
+        }
+
+        const char* p = file.data();
+        const char* end = file.end();
+        int lineNumber = 0;
+        std::vector<std::string_view> characteristics;
+        while (p < end) {
+            std::string_view line = scan::nextLine(p, end);
+            lineNumber++;
+            if (line == "edges") {
+                readEdgeSection(p, end, lineNumber);
+                break;
+            }
+
+            const char* q = line.data();
+            const char* lineEnd = q + line.size();
+            int id;
+            if (!scan::parseInt(q, lineEnd, id)) {
+                std::cerr << "Error reading node ID at line " << lineNumber << std::endl;
+                continue;
+            }
+            characteristics.clear();
+            for (std::string_view token = scan::nextToken(q, lineEnd); !token.empty();
+                 token = scan::nextToken(q, lineEnd)) {
+                characteristics.push_back(token);
+            }
+            addNode(id, characteristics);
+        }
+        return true;
+    }
+
+    // Flattens the network into snapshot::Data: sorted IDs, an interned
+    // characteristic dictionary and offset/value arrays for both relations.
+    bool saveSnapshot(const std::string& filename) const {
+        snapshot::Data data;
+
+        for (uint32_t id = 0; id < dictionary.size(); ++id) {
+            const std::string& characteristic = dictionary.name(id);
+            data.dictBytes.insert(data.dictBytes.end(), characteristic.begin(), characteristic.end());
+            data.dictOffsets.push_back(static_cast<uint32_t>(data.dictBytes.size()));
+        }
+
+        data.vertexIds = index.externalIds();
+        nodes.exportColumns(data.vertexFlags, data.nodeCharOffsets, data.nodeCharIds);
+        for (uint8_t& flag : data.vertexFlags) {
+            flag = flag ? snapshot::kDeclared : 0;
+        }
+
+        // The CSR arrays are the snapshot's adjacency sections verbatim.
+        CsrGraph merged;
+        const CsrGraph& graph = frozenGraph(merged);
+        data.adjOffsets = graph.rowOffsets();
+        data.adjTargets = graph.rowTargets();
+
+        if (!lookalikes.empty()) {
+            const lookalike::Options& options = lookalikes.options();
+            data.lookalikeParams = {options.hashes, options.bands, options.seed};
+            data.lookalikeRows = lookalikes.signatures();
+        }
+
+        if (!snapshot::write(filename, data)) {
+            std::cerr << "Error writing snapshot: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Replaces the current contents with a snapshot written by saveSnapshot.
+    // View::open has validated every section; the arrays are then bulk-copied
+    // out of the mapping, and the dictionary lookup and posting lists are
+    // rebuilt from them.
+    bool loadSnapshot(const std::string& filename) {
+        snapshot::View view;
+        std::string error;
+        if (!view.open(filename, error)) {
+            std::cerr << "Error loading snapshot " << filename << ": " << error << std::endl;
+            return false;
+        }
+
+        size_t n = view.vertexIds().size();
+        auto vertexFlags = view.vertexFlags();
+        auto charOffsets = view.nodeCharOffsets();
+        auto charIds = view.nodeCharIds();
+        auto adjOffsets = view.adjOffsets();
+        auto adjTargets = view.adjTargets();
+
+        nodes.clear();
+        adjList.clear();
+        lookalikes = lookalike::Index();
+        dictionary.clear();
+        postings.clear();
+        if (!index.assign(std::vector<int>(view.vertexIds().begin(), view.vertexIds().end()))) {
+            std::cerr << "Error loading snapshot " << filename << ": duplicate vertex ID" << std::endl;
+            return false;
+        }
+        for (uint32_t i = 0; i < view.dictSize(); ++i) {
+            dictionary.intern(view.dictEntry(i));
+        }
+
+        std::vector<uint8_t> declared(n);
+        for (uint32_t v = 0; v < n; ++v) {
+            declared[v] = (vertexFlags[v] & snapshot::kDeclared) ? 1 : 0;
+        }
+        nodes.assign(std::move(declared), std::vector<uint32_t>(charOffsets.begin(), charOffsets.end()),
+                     std::vector<uint32_t>(charIds.begin(), charIds.end()));
+        postings.rebuild(n, dictionary.size(), [&](uint32_t v) -> std::optional<std::pair<const uint32_t*, const uint32_t*>> {
+            if (!nodes.isDeclared(v)) {
+                return std::nullopt;
+            }
+            return std::make_pair(nodes.charBegin(v), nodes.charEnd(v));
+        });
+
+        adjList.assign(std::vector<uint64_t>(adjOffsets.begin(), adjOffsets.end()),
+                       std::vector<uint32_t>(adjTargets.begin(), adjTargets.end()));
+
+        // Saved signatures only need their band tables rebuilt.
+        auto params = view.lookalikeParams();
+        if (params.size() == 3) {
+            lookalike::Options options;
+            options.hashes = static_cast<unsigned>(params[0]);
+            options.bands = static_cast<unsigned>(params[1]);
+            options.seed = params[2];
+            auto rows = view.lookalikeRows();
+            lookalikes = lookalike::Index::restore(options, std::vector<uint32_t>(rows.begin(), rows.end()), n,
+                                                   [&](uint32_t v) { return nodes.isDeclared(v); });
+        }
+        return true;
+    }
+
+    // Startup path for the apps: use the snapshot next to the text file when it
+    // is at least as new, otherwise fall back to parsing the text.
+    bool load(const std::string& textFile) {
+        std::string snapshotFile = snapshot::pathFor(textFile);
+        if (snapshot::isFresh(snapshotFile, textFile) && loadSnapshot(snapshotFile)) {
+            return true;
+        }
+        return readFromFile(textFile);
+    }
+
+    size_t nodeCount() const { return nodes.declaredCount(); }
+
+    NodeView node(uint32_t v) const {
+        return NodeView(index.externalId(v), v, nodes.charBegin(v), nodes.charEnd(v));
+    }
+
+    // Looks a node up by external ID; empty if it never had a node line.
+    std::optional<NodeView> findNode(int id) const {
+        uint32_t v = index.find(id);
+        if (v == NodeIndex::kMissing || !nodes.isDeclared(v)) {
+            return std::nullopt;
+        }
+        return node(v);
+    }
+
+    // Linear pass over the node columns in dense order.
+    template <typename F>
+    void forEachNode(F f) const {
+        for (uint32_t v = 0; v < nodes.size(); ++v) {
+            if (nodes.isDeclared(v)) {
+                f(node(v));
+            }
+        }
+    }
+
+    const CharacteristicDictionary& getAvailableCharacteristics() const {
+        return dictionary;
+    }
+
+private:
+    // Dense index for an external ID, creating it (and its empty node slot)
+    // on first sight.
+    uint32_t vertex(int id) {
+        uint32_t v = index.intern(id);
+        if (v >= nodes.size()) {
+            nodes.resize(v + 1);
+            adjList.addRows(v + 1);
+        }
+        return v;
+    }
+
+    // The adjacency with every vertex as a frozen row. Writers flush after
+    // bulk loads and once a stream goes quiet, so this is usually adjList
+    // itself; while a live stream still holds edges in the delta (at most
+    // max(4096, E/8) entries), a merged copy is built in `scratch`.
+    const CsrGraph& frozenGraph(CsrGraph& scratch) const {
+        if (!adjList.hasPending() && adjList.rowCount() >= index.size()) {
+            return adjList;
+        }
+        scratch = adjList;
+        scratch.freeze(index.size());
+        return scratch;
+    }
+
+    // Dense indexes for external IDs, skipping unknown ones.
+    std::vector<uint32_t> denseIds(const std::vector<int>& ids) const {
+        std::vector<uint32_t> result;
+        for (int id : ids) {
+            uint32_t v = index.find(id);
+            if (v != NodeIndex::kMissing) {
+                result.push_back(v);
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::pair<int, double>> lookalikeMatches(const std::vector<uint32_t>& seeds, size_t k) const {
+        std::vector<std::pair<int, double>> result;
+        for (const lookalike::Match& match : lookalikes.query(seeds, k)) {
+            result.push_back({index.externalId(match.vertex), match.similarity});
+        }
+        return result;
+    }
+
+    // EdgeProbability as a probability(from, to) rule: the shared count is a
+    // merge over the two sorted characteristic runs.
+    struct SharedCharacteristicRule {
+        diffusion::EdgeProbability probability;
+        const CsrGraph* graph;
+
+        double operator()(const NodeView& from, const NodeView& to) const {
+            size_t shared = 0;
+            const uint32_t* a = from.begin();
+            const uint32_t* b = to.begin();
+            while (a != from.end() && b != to.end()) {
+                if (*a < *b) {
+                    ++a;
+                } else if (*b < *a) {
+                    ++b;
+                } else {
+                    ++shared, ++a, ++b;
+                }
+            }
+            double p = probability.base + probability.perSharedCharacteristic * shared;
+            if (probability.weightedCascade) {
+                p /= std::max<size_t>(1, graph->degree(to.index()));
+            }
+            return p;
+        }
+    };
+
+    // Evaluates the rule once per CSR entry, clamped to [0, 1]. For row u and
+    // target v, weights[e] is p(u -> v), or p(v -> u) when `incoming` (what
+    // reverse sampling and LT normalization need).
+    template <typename Probability>
+    void edgeWeights(const CsrGraph& graph, Probability probability, bool incoming, std::vector<float>& weights) const {
+        weights.assign(graph.rowTargets().size(), 0);
+        parallel::forBlocks(graph.rowCount(), [&](size_t begin, size_t end, unsigned) {
+            for (uint32_t u = static_cast<uint32_t>(begin); u < end; ++u) {
+                for (uint64_t e = graph.rowOffsets()[u]; e < graph.rowOffsets()[u + 1]; ++e) {
+                    uint32_t v = graph.rowTargets()[e];
+                    double p = incoming ? probability(node(v), node(u)) : probability(node(u), node(v));
+                    weights[e] = static_cast<float>(std::min(1.0, std::max(0.0, p)));
+                }
+            }
+        });
+    }
+
+    // Per-vertex ranking scores for the non-degree modes; empty for Degree,
+    // which reads the degree directly.
+    std::vector<double> dominanceScores(DominanceMode mode) const {
+        std::vector<double> scores;
+        if (mode == DominanceMode::PageRank) {
+            scores = pageRank().scores;
+        } else if (mode == DominanceMode::Betweenness) {
+            centrality::BetweennessOptions options;
+            options.samples = kDominanceBetweennessSamples;
+            scores = betweenness(options).scores;
+        } else if (mode == DominanceMode::Coreness) {
+            // Degree is below one, so it only orders nodes within a core.
+            std::vector<uint32_t> coreness = coreDecomposition().coreness;
+            scores.resize(coreness.size());
+            for (uint32_t v = 0; v < coreness.size(); ++v) {
+                scores[v] = coreness[v] + adjList.degree(v) / (adjList.degree(v) + 1.0);
+            }
+        } else if (mode == DominanceMode::Clustering) {
+            scores = triangles().clustering;
+        }
+        return scores;
+    }
+
+    static void sortUnique(std::vector<uint32_t>& ids) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    // Turns query strings into sorted IDs once per query. Returns false when a
+    // target was never seen, i.e. nothing can match.
+    bool resolve(const std::unordered_set<std::string>& names, std::vector<uint32_t>& ids) const {
+        ids.clear();
+        for (const std::string& name : names) {
+            uint32_t id = dictionary.find(name);
+            if (id == CharacteristicDictionary::kMissing) {
+                return false;
+            }
+            ids.push_back(id);
+        }
+        sortUnique(ids);
+        return true;
+    }
+
+    // Everything after the "edges" marker is parsed in parallel chunks, then
+    // errors are reported in file order using each chunk's line count.
+    void readEdgeSection(const char* begin, const char* end, int markerLine) {
+        std::vector<ingest::EdgeChunk> chunks = ingest::parseEdges(begin, end);
+        int firstLine = markerLine + 1;
+        for (const auto& chunk : chunks) {
+            for (int badLine : chunk.badLines) {
+                std::cerr << "Error reading edge at line " << firstLine + badLine << std::endl;
+            }
+            firstLine += chunk.lineCount;
+        }
+        addEdges(chunks);
+        flushEdges();
+    }
+
+    // Sources sampled when ranking dominance by betweenness, so a button
+    // click stays interactive; small graphs below this run exact.
+    static constexpr size_t kDominanceBetweennessSamples = 256;
+
+    // Both are indexed by dense vertex index; vertices that only ever appeared
+    // in the edge section are present but not declared in `nodes`.
+    NodeIndex index;
+    NodeStore nodes;
+    CsrGraph adjList;
+    CharacteristicDictionary dictionary;
+    PostingIndex postings; // characteristic ID -> declared vertices holding it
+    lookalike::Index lookalikes; // empty until buildLookalikes or a snapshot load
+    std::vector<uint32_t> scratchIds;
+};
+
+#endif // SOCIAL_NETWORK_H
@@ -0,0 +1,370 @@
+#ifndef STREAM_INGEST_H
+#define STREAM_INGEST_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+#include "social_network.h"
+
+// Continuous ingest of node and edge records from stdin, a FIFO or a file
+// that keeps growing. Records use the nodes.txt grammar: node lines until an
+// "edges" line, edge lines after it; a "nodes" line switches back, so a
+// producer can keep interleaving new users and friendships.
+//
+// Input is applied in batches. Each batch is parsed without holding the lock
+// and then applied under an exclusive lock on the caller's mutex, so readers
+// that hold a shared lock always see the graph at a batch boundary. Batches
+// are cut at batchRecords, when poll times out, at end of input, or once a
+// steady trickle has waited a poll interval, never per read.
+struct IngestStats {
+    uint64_t records = 0;
+    uint64_t nodes = 0;
+    uint64_t edges = 0;
+    uint64_t errors = 0;
+    uint64_t batches = 0;
+    double seconds = 0;
+
+    double recordsPerSecond() const { return seconds > 0 ? records / seconds : 0; }
+};
+
+class StreamIngest {
+public:
+    struct Options {
+        size_t batchRecords = 1 << 16; // apply at least this often
+        bool follow = true;            // keep waiting for data at end of a regular file or FIFO
+        int pollMillis = 200;
+        bool reportProgress = true;    // throughput line on stderr about once a second
+    };
+
+    StreamIngest(SocialNetwork& network, std::shared_mutex& lock) : StreamIngest(network, lock, Options()) {}
+
+    StreamIngest(SocialNetwork& network, std::shared_mutex& lock, Options options)
+        : network(network), lock(lock), options(options) {}
+
+    ~StreamIngest() { stop(); }
+
+    StreamIngest(const StreamIngest&) = delete;
+    StreamIngest& operator=(const StreamIngest&) = delete;
+
+    // Starts ingesting `source` ("-" for stdin) on a background thread.
+    bool start(const std::string& source) {
+        int fd = openSource(source);
+        if (fd < 0) {
+            std::cerr << "Error opening stream: " << source << std::endl;
+            return false;
+        }
+        stopping = false;
+        worker = std::thread([this, fd, source] { run(fd, source); });
+        return true;
+    }
+
+    // Ingests `source` on the calling thread until end of input (stdin, or a
+    // file/FIFO with follow disabled) or until stop() is called elsewhere.
+    bool runToEnd(const std::string& source) {
+        int fd = openSource(source);
+        if (fd < 0) {
+            std::cerr << "Error opening stream: " << source << std::endl;
+            return false;
+        }
+        run(fd, source);
+        return true;
+    }
+
+    void stop() {
+        stopping = true;
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    bool running() const { return active; }
+
+    IngestStats stats() const {
+        std::lock_guard<std::mutex> guard(statsMutex);
+        IngestStats copy = current;
+        if (active) {
+            copy.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+        }
+        return copy;
+    }
+
+private:
+    static int openSource(const std::string& source) {
+        if (source == "-") {
+            return dup(STDIN_FILENO);
+        }
+        // O_NONBLOCK so opening a FIFO does not wait for a writer; reads are
+        // driven by poll() below, so the flag is cleared again.
+        int fd = ::open(source.c_str(), O_RDONLY | O_NONBLOCK);
+        if (fd >= 0) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        }
+        return fd;
+    }
+
+    void run(int fd, const std::string& source) {
+        struct stat st;
+        bool known = fstat(fd, &st) == 0;
+        bool regular = known && S_ISREG(st.st_mode);
+        bool fifo = known && S_ISFIFO(st.st_mode);
+        bool isStdin = source == "-";
+        off_t offset = 0;
+
+        {
+            std::lock_guard<std::mutex> guard(statsMutex);
+            active = true;
+            startedAt = std::chrono::steady_clock::now();
+        }
+        auto lastReport = startedAt;
+        auto lastApply = startedAt;
+        auto lastInput = startedAt;
+        const auto latency = std::chrono::milliseconds(options.pollMillis);
+        std::string buffer;
+        size_t pendingLines = 0; // complete lines in `buffer`, counted as they arrive
+        std::vector<char> chunk(1 << 20);
+
+        while (!stopping) {
+            pollfd pfd{fd, POLLIN, 0};
+            int ready = regular ? 1 : poll(&pfd, 1, options.pollMillis);
+            if (ready == 0) {
+                applyBatch(buffer, false);
+                pendingLines = 0;
+                lastApply = std::chrono::steady_clock::now();
+                foldWhenQuiet(lastInput);
+                continue;
+            }
+            ssize_t n = ready < 0 ? -1 : read(fd, chunk.data(), chunk.size());
+            if (n < 0) {
+                break;
+            }
+            if (n == 0) {
+                // End of input right now. Flush what we have, then either stop
+                // or wait for more, depending on the source.
+                applyBatch(buffer, isStdin || !options.follow);
+                pendingLines = 0;
+                lastApply = std::chrono::steady_clock::now();
+                if (isStdin || !options.follow) {
+                    std::unique_lock<std::shared_mutex> writer(lock);
+                    network.flushEdges();
+                    break;
+                }
+                foldWhenQuiet(lastInput);
+                if (regular && fstat(fd, &st) == 0 && st.st_size < offset) {
+                    std::cerr << "Stream " << source << " was truncated; reading from the start" << std::endl;
+                    lseek(fd, 0, SEEK_SET);
+                    offset = 0;
+                    readingNodes = true;
+                    lineNumber = 0;
+                    buffer.clear();
+                    pendingLines = 0;
+                } else if (fifo) {
+                    // The writer went away; reopen to wait for the next one.
+                    close(fd);
+                    fd = openSource(source);
+                    if (fd < 0) {
+                        break;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(options.pollMillis));
+                continue;
+            }
+            offset += n;
+            buffer.append(chunk.data(), static_cast<size_t>(n));
+            pendingLines += static_cast<size_t>(std::count(chunk.data(), chunk.data() + n, '\n'));
+            auto now = std::chrono::steady_clock::now();
+            lastInput = now;
+            // A short read is not a reason to apply: a slow producer would
+            // turn every line into its own batch. A steady trickle that never
+            // lets poll time out is still applied at the poll interval.
+            if (pendingLines >= options.batchRecords || (pendingLines > 0 && now - lastApply >= latency)) {
+                applyBatch(buffer, false);
+                pendingLines = 0;
+                lastApply = now;
+            }
+
+            if (options.reportProgress && now - lastReport >= std::chrono::seconds(1)) {
+                lastReport = now;
+                report();
+            }
+        }
+        close(fd);
+        {
+            std::lock_guard<std::mutex> guard(statsMutex);
+            current.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+            active = false;
+        }
+        if (options.reportProgress) {
+            report();
+        }
+    }
+
+    // Parses every complete line in `buffer` (and the trailing partial line if
+    // `final`), applies the result as one batch and keeps the unparsed tail.
+    void applyBatch(std::string& buffer, bool final) {
+        size_t complete = buffer.rfind('\n');
+        size_t usable = final ? buffer.size() : (complete == std::string::npos ? 0 : complete + 1);
+        if (usable == 0) {
+            return;
+        }
+
+        struct NodeRecord {
+            int id;
+            size_t first;
+            size_t last;
+        };
+        std::vector<NodeRecord> nodeRecords;
+        std::vector<std::string_view> tokens;
+        ingest::EdgeChunk edgeChunk;
+        uint64_t errors = 0;
+
+        // Node and edge records are applied in stream order, so a mode switch
+        // closes the current run and starts another.
+        std::vector<std::pair<bool, size_t>> runs; // (isNodeRun, end index)
+        auto closeRun = [&] {
+            size_t end = readingNodes ? nodeRecords.size() : edgeChunk.edges.size();
+            if (runs.empty() || runs.back().first != readingNodes) {
+                runs.push_back({readingNodes, end});
+            } else {
+                runs.back().second = end;
+            }
+        };
+
+        const char* p = buffer.data();
+        const char* end = buffer.data() + usable;
+        while (p < end) {
+            std::string_view line = scan::nextLine(p, end);
+            lineNumber++;
+            if (line == "edges" || line == "nodes") {
+                closeRun();
+                readingNodes = (line == "nodes");
+                continue;
+            }
+            const char* q = line.data();
+            const char* lineEnd = q + line.size();
+            if (readingNodes) {
+                int id;
+                if (!scan::parseInt(q, lineEnd, id)) {
+                    std::cerr << "Error reading node ID at stream line " << lineNumber << std::endl;
+                    ++errors;
+                    continue;
+                }
+                size_t first = tokens.size();
+                for (std::string_view token = scan::nextToken(q, lineEnd); !token.empty();
+                     token = scan::nextToken(q, lineEnd)) {
+                    tokens.push_back(token);
+                }
+                nodeRecords.push_back({id, first, tokens.size()});
+            } else {
+                int id1, id2;
+                if (!scan::parseInt(q, lineEnd, id1) || !scan::parseInt(q, lineEnd, id2)) {
+                    std::cerr << "Error reading edge at stream line " << lineNumber << std::endl;
+                    ++errors;
+                    continue;
+                }
+                edgeChunk.edges.emplace_back(id1, id2);
+            }
+        }
+        closeRun();
+
+        {
+            std::unique_lock<std::shared_mutex> writer(lock);
+            size_t nodeAt = 0, edgeAt = 0;
+            std::vector<std::string_view> characteristics;
+            for (const auto& run : runs) {
+                if (run.first) {
+                    for (; nodeAt < run.second; ++nodeAt) {
+                        const NodeRecord& record = nodeRecords[nodeAt];
+                        characteristics.assign(tokens.begin() + record.first, tokens.begin() + record.last);
+                        network.addNode(record.id, characteristics);
+                    }
+                } else {
+                    applyEdges(edgeChunk.edges, edgeAt, run.second);
+                    edgeAt = run.second;
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(statsMutex);
+            current.nodes += nodeRecords.size();
+            current.edges += edgeChunk.edges.size();
+            current.records += nodeRecords.size() + edgeChunk.edges.size();
+            current.errors += errors;
+            current.batches++;
+        }
+        buffer.erase(0, usable);
+    }
+
+    // Small runs go through the CSR overflow delta edge by edge, which readers
+    // traverse directly and which folds itself in once it passes the CSR's own
+    // threshold. Large runs are staged and merged in one pass, so their cost
+    // is amortized over the run rather than paid per batch.
+    void applyEdges(const std::vector<std::pair<int, int>>& edges, size_t first, size_t last) {
+        if (last - first >= kBulkEdges) {
+            std::vector<ingest::EdgeChunk> chunks(1);
+            chunks[0].edges.assign(edges.begin() + first, edges.begin() + last);
+            network.addEdges(chunks);
+            network.flushEdges();
+            return;
+        }
+        for (size_t i = first; i < last; ++i) {
+            network.addEdge(edges[i].first, edges[i].second);
+        }
+    }
+
+    // Once the producer has gone quiet, folds whatever the delta still holds
+    // so the analytics read the CSR in place until input resumes. Folding
+    // per batch instead would make a trickling producer cost O(edges) a line.
+    void foldWhenQuiet(std::chrono::steady_clock::time_point lastInput) {
+        // This thread is the only writer, so the check needs no lock.
+        if (!network.hasPendingEdges() || std::chrono::steady_clock::now() - lastInput < kQuietBeforeFold) {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> writer(lock);
+        network.flushEdges();
+    }
+
+    void report() {
+        IngestStats snapshot = stats();
+        std::cerr << "Ingested " << snapshot.records << " records (" << snapshot.nodes << " nodes, "
+                  << snapshot.edges << " edges, " << snapshot.errors << " errors) in " << snapshot.batches
+                  << " batches, " << static_cast<uint64_t>(snapshot.recordsPerSecond()) << " records/s" << std::endl;
+    }
+
+    static constexpr size_t kBulkEdges = 1 << 16;
+    static constexpr std::chrono::seconds kQuietBeforeFold{1};
+
+    SocialNetwork& network;
+    std::shared_mutex& lock;
+    Options options;
+
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> active{false};
+
+    // Parser state carried across batches.
+    bool readingNodes = true;
+    uint64_t lineNumber = 0;
+
+    mutable std::mutex statsMutex;
+    IngestStats current;
+    std::chrono::steady_clock::time_point startedAt;
+};
+
+#endif // STREAM_INGEST_H
@@ -0,0 +1,349 @@
+#ifndef TARGET_QUERY_H
+#define TARGET_QUERY_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "characteristic_dictionary.h"
+#include "posting_index.h"
+#include "roaring_bitmap.h"
+
+// Boolean targeting expressions over characteristics, e.g.
+//
+//     (coder OR gamer) AND NOT weeb
+//
+// Operators are AND / OR / NOT (upper case) or & | !, with NOT binding
+// tightest and AND tighter than OR. Adjacent terms are ANDed, so the old
+// space-separated lists mean what they always did, and an empty expression
+// matches every declared node. Unknown characteristics match nothing.
+//
+// compile() folds the parse tree into a plan of n-ary AND / OR nodes:
+// nested ANDs and ORs are flattened, NOT under AND becomes an ANDNOT against
+// the running result (and NOT (a OR b) two of them) rather than a
+// complement, and constants are folded. AND operands run from the smallest
+// posting list up and stop at the first empty intermediate.
+class TargetQuery {
+public:
+    // The plan for `text`; nullopt with `error` set on a syntax error.
+    static std::optional<TargetQuery> compile(std::string_view text, const CharacteristicDictionary& dictionary,
+                                              const PostingIndex& postings, std::string& error) {
+        TargetQuery query;
+        query.allEstimate = postings.declared().cardinality();
+        Parser parser{text, 0, dictionary, postings, query, error};
+        parser.next();
+        if (parser.token.kind == Token::End) {
+            query.root = query.add(Node{Op::All, 0, {}, {}, query.allEstimate});
+            return query;
+        }
+        std::optional<uint32_t> root = parser.parseOr();
+        if (root && parser.token.kind != Token::End) {
+            error = "unexpected '" + std::string(parser.token.text) + "' at position " + std::to_string(parser.start);
+            root.reset();
+        }
+        if (!root) {
+            return std::nullopt;
+        }
+        query.root = *root;
+        return query;
+    }
+
+    // Declared vertices matching the expression.
+    RoaringBitmap run(const PostingIndex& postings) const { return evaluate(root, postings); }
+
+    // The plan in evaluation order with estimated sizes, for diagnostics.
+    std::string explain(const CharacteristicDictionary& dictionary) const { return describe(root, dictionary); }
+
+private:
+    enum class Op : uint8_t { Term, Empty, All, And, Or };
+
+    // And: include[0] (or all declared nodes when empty) ANDed with the rest,
+    // then ANDNOT each exclude. Or: union of include. estimate bounds the
+    // cardinality and drives the ordering.
+    struct Node {
+        Op op;
+        uint32_t characteristic;
+        std::vector<uint32_t> include, exclude;
+        uint64_t estimate;
+    };
+
+    struct Token {
+        enum Kind { End, Word, And, Or, Not, Open, Close } kind;
+        std::string_view text;
+    };
+
+    struct Parser {
+        std::string_view text;
+        size_t pos;
+        const CharacteristicDictionary& dictionary;
+        const PostingIndex& postings;
+        TargetQuery& query;
+        std::string& error;
+        Token token{Token::End, {}};
+        size_t start = 0;
+
+        void next() {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+                ++pos;
+            }
+            start = pos;
+            if (pos == text.size()) {
+                token = {Token::End, {}};
+                return;
+            }
+            char c = text[pos];
+            if (c == '(' || c == ')' || c == '!' || c == '&' || c == '|') {
+                ++pos;
+                Token::Kind kind = c == '(' ? Token::Open : c == ')' ? Token::Close : c == '!' ? Token::Not
+                                   : c == '&' ? Token::And : Token::Or;
+                token = {kind, text.substr(start, 1)};
+                return;
+            }
+            while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos])) &&
+                   std::string_view("()!&|").find(text[pos]) == std::string_view::npos) {
+                ++pos;
+            }
+            std::string_view word = text.substr(start, pos - start);
+            Token::Kind kind = word == "AND" ? Token::And : word == "OR" ? Token::Or : word == "NOT" ? Token::Not
+                                                                                                       : Token::Word;
+            token = {kind, word};
+        }
+
+        bool startsOperand() const {
+            return token.kind == Token::Word || token.kind == Token::Not || token.kind == Token::Open;
+        }
+
+        std::optional<uint32_t> parseOr() {
+            std::vector<uint32_t> operands;
+            do {
+                if (!operands.empty()) {
+                    next();
+                }
+                std::optional<uint32_t> operand = parseAnd();
+                if (!operand) {
+                    return std::nullopt;
+                }
+                operands.push_back(*operand);
+            } while (token.kind == Token::Or);
+            return query.makeOr(operands);
+        }
+
+        std::optional<uint32_t> parseAnd() {
+            std::vector<uint32_t> operands;
+            for (;;) {
+                std::optional<uint32_t> operand = parseUnary();
+                if (!operand) {
+                    return std::nullopt;
+                }
+                operands.push_back(*operand);
+                if (token.kind == Token::And) {
+                    next();
+                } else if (!startsOperand()) {
+                    break;
+                }
+            }
+            return query.makeAnd(operands, {});
+        }
+
+        std::optional<uint32_t> parseUnary() {
+            if (token.kind == Token::Not) {
+                next();
+                std::optional<uint32_t> operand = parseUnary();
+                if (!operand) {
+                    return std::nullopt;
+                }
+                return query.makeAnd({}, {*operand});
+            }
+            if (token.kind == Token::Open) {
+                next();
+                std::optional<uint32_t> inner = parseOr();
+                if (!inner) {
+                    return std::nullopt;
+                }
+                if (token.kind != Token::Close) {
+                    error = "expected ')' at position " + std::to_string(start);
+                    return std::nullopt;
+                }
+                next();
+                return inner;
+            }
+            if (token.kind == Token::Word) {
+                uint32_t id = dictionary.find(token.text);
+                next();
+                if (id == CharacteristicDictionary::kMissing) {
+                    return query.add(Node{Op::Empty, 0, {}, {}, 0});
+                }
+                return query.add(Node{Op::Term, id, {}, {}, postings.list(id).cardinality()});
+            }
+            error = token.kind == Token::End ? "expression ends early"
+                                             : "unexpected '" + std::string(token.text) + "' at position " +
+                                                   std::to_string(start);
+            return std::nullopt;
+        }
+    };
+
+    uint32_t add(Node node) {
+        nodes.push_back(std::move(node));
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    uint64_t everyone() const { return allEstimate; }
+
+    // AND of `include` minus every `exclude`, flattened and folded.
+    uint32_t makeAnd(const std::vector<uint32_t>& include, const std::vector<uint32_t>& exclude) {
+        Node node{Op::And, 0, {}, {}, 0};
+        std::vector<uint32_t> pendingInclude = include, pendingExclude = exclude;
+        while (!pendingInclude.empty() || !pendingExclude.empty()) {
+            bool included = !pendingInclude.empty();
+            std::vector<uint32_t>& pending = included ? pendingInclude : pendingExclude;
+            uint32_t child = pending.back();
+            pending.pop_back();
+            const Node& c = nodes[child];
+            if (c.op == (included ? Op::Empty : Op::All)) {
+                return add(Node{Op::Empty, 0, {}, {}, 0});
+            }
+            if (c.op == (included ? Op::All : Op::Empty)) {
+                continue;
+            }
+            if (included && c.op == Op::And) {
+                pendingInclude.insert(pendingInclude.end(), c.include.begin(), c.include.end());
+                pendingExclude.insert(pendingExclude.end(), c.exclude.begin(), c.exclude.end());
+            } else if (!included && c.op == Op::Or) {
+                // NOT (a OR b) = NOT a AND NOT b: two ANDNOTs, no union.
+                pendingExclude.insert(pendingExclude.end(), c.include.begin(), c.include.end());
+            } else if (!included && c.op == Op::And && c.include.empty() && c.exclude.size() == 1) {
+                // NOT NOT x = x.
+                pendingInclude.push_back(c.exclude.front());
+            } else {
+                (included ? node.include : node.exclude).push_back(child);
+            }
+        }
+
+        if (node.include.size() == 1 && node.exclude.empty()) {
+            return node.include.front();
+        }
+        if (node.include.empty() && node.exclude.empty()) {
+            return add(Node{Op::All, 0, {}, {}, everyone()});
+        }
+
+        auto smaller = [&](uint32_t a, uint32_t b) { return nodes[a].estimate < nodes[b].estimate; };
+        std::stable_sort(node.include.begin(), node.include.end(), smaller);
+        std::stable_sort(node.exclude.begin(), node.exclude.end(), [&](uint32_t a, uint32_t b) { return smaller(b, a); });
+        node.estimate = node.include.empty() ? everyone() : nodes[node.include.front()].estimate;
+        return add(std::move(node));
+    }
+
+    uint32_t makeOr(const std::vector<uint32_t>& operands) {
+        Node node{Op::Or, 0, {}, {}, 0};
+        std::vector<uint32_t> pending(operands.rbegin(), operands.rend());
+        while (!pending.empty()) {
+            uint32_t child = pending.back();
+            pending.pop_back();
+            const Node& c = nodes[child];
+            if (c.op == Op::All) {
+                return child;
+            }
+            if (c.op == Op::Or) {
+                pending.insert(pending.end(), c.include.rbegin(), c.include.rend());
+            } else if (c.op != Op::Empty) {
+                node.include.push_back(child);
+                node.estimate = std::min(everyone(), node.estimate + c.estimate);
+            }
+        }
+        if (node.include.empty()) {
+            return add(Node{Op::Empty, 0, {}, {}, 0});
+        }
+        if (node.include.size() == 1) {
+            return node.include.front();
+        }
+        // Largest first, so a union that already covers everyone stops early.
+        std::stable_sort(node.include.begin(), node.include.end(),
+                         [&](uint32_t a, uint32_t b) { return nodes[a].estimate > nodes[b].estimate; });
+        return add(std::move(node));
+    }
+
+    // Calls f with the set for node i; posting lists are passed without a copy.
+    template <typename F>
+    void withSet(uint32_t i, const PostingIndex& postings, F f) const {
+        if (nodes[i].op == Op::Term) {
+            f(postings.list(nodes[i].characteristic));
+        } else {
+            f(evaluate(i, postings));
+        }
+    }
+
+    RoaringBitmap evaluate(uint32_t i, const PostingIndex& postings) const {
+        const Node& node = nodes[i];
+        switch (node.op) {
+            case Op::Empty:
+                return RoaringBitmap();
+            case Op::All:
+                return postings.declared();
+            case Op::Term:
+                return postings.list(node.characteristic);
+            case Op::Or: {
+                RoaringBitmap result;
+                uint64_t declared = postings.declared().cardinality();
+                for (uint32_t child : node.include) {
+                    withSet(child, postings, [&](const RoaringBitmap& set) { result = RoaringBitmap::orOf(result, set); });
+                    if (result.cardinality() == declared) {
+                        break;
+                    }
+                }
+                return result;
+            }
+            case Op::And: {
+                RoaringBitmap result = node.include.empty() ? postings.declared() : evaluate(node.include.front(), postings);
+                for (size_t k = 1; k < node.include.size() && !result.empty(); ++k) {
+                    withSet(node.include[k], postings,
+                            [&](const RoaringBitmap& set) { result = RoaringBitmap::andOf(result, set); });
+                }
+                for (size_t k = 0; k < node.exclude.size() && !result.empty(); ++k) {
+                    withSet(node.exclude[k], postings,
+                            [&](const RoaringBitmap& set) { result = RoaringBitmap::andNotOf(result, set); });
+                }
+                return result;
+            }
+        }
+        return RoaringBitmap();
+    }
+
+    std::string describe(uint32_t i, const CharacteristicDictionary& dictionary) const {
+        const Node& node = nodes[i];
+        switch (node.op) {
+            case Op::Empty:
+                return "EMPTY";
+            case Op::All:
+                return "ALL";
+            case Op::Term:
+                return dictionary.name(node.characteristic) + "[" + std::to_string(node.estimate) + "]";
+            case Op::Or:
+            case Op::And: {
+                std::string text = "(";
+                const char* separator = node.op == Op::Or ? " OR " : " AND ";
+                for (size_t k = 0; k < node.include.size(); ++k) {
+                    text += (k ? separator : "") + describe(node.include[k], dictionary);
+                }
+                if (node.include.empty()) {
+                    text += "ALL";
+                }
+                for (uint32_t child : node.exclude) {
+                    text += " ANDNOT " + describe(child, dictionary);
+                }
+                return text + ")";
+            }
+        }
+        return {};
+    }
+
+    std::vector<Node> nodes;
+    uint32_t root = 0;
+    uint64_t allEstimate = 0;
+};
+
+#endif // TARGET_QUERY_H
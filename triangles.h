@@ -0,0 +1,120 @@
+#ifndef TRIANGLES_H
+#define TRIANGLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "intersect_kernels.h"
+#include "parallel.h"
+
+namespace centrality {
+
+struct TriangleResult {
+    std::vector<uint64_t> triangles; // per dense vertex
+    std::vector<double> clustering;  // local coefficient; 0 below two neighbors
+    uint64_t total = 0;
+    double transitivity = 0;         // 3 * triangles / connected triples
+    double averageClustering = 0;    // over vertices with at least two neighbors
+};
+
+// Each edge is oriented from the lower to the higher (degree, index) end, so
+// every triangle is found exactly once, from its lowest vertex, and no out-row
+// is longer than sqrt(2m). Triangle v -> u -> w is the intersection of the
+// out-rows of v and u; the matches are credited to all three corners.
+inline TriangleResult triangles(const CsrGraph& graph) {
+    TriangleResult result;
+    size_t n = graph.rowCount();
+    const std::vector<uint64_t>& offsets = graph.rowOffsets();
+    const std::vector<uint32_t>& targets = graph.rowTargets();
+
+    std::vector<uint32_t> degree(n);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t d = 0;
+            for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                d += targets[e] != v;
+            }
+            degree[v] = d;
+        }
+    });
+    auto below = [&](uint32_t v, uint32_t u) { return degree[v] < degree[u] || (degree[v] == degree[u] && v < u); };
+
+    // Out-rows keep the ascending order of the full rows.
+    std::vector<uint64_t> outStart(n + 1, 0);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            uint64_t count = 0;
+            for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                count += below(static_cast<uint32_t>(v), targets[e]);
+            }
+            outStart[v + 1] = count;
+        }
+    });
+    for (size_t v = 0; v < n; ++v) {
+        outStart[v + 1] += outStart[v];
+    }
+    std::vector<uint32_t> out(outStart[n]);
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        for (size_t v = begin; v < end; ++v) {
+            uint64_t fill = outStart[v];
+            for (uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                if (below(static_cast<uint32_t>(v), targets[e])) {
+                    out[fill++] = targets[e];
+                }
+            }
+        }
+    });
+
+    kernels::IntersectOp intersect = kernels::intersect();
+    result.triangles.assign(n, 0);
+    std::vector<uint64_t>& count = result.triangles;
+    parallel::forBlocks(n, [&](size_t begin, size_t end, unsigned) {
+        std::vector<uint32_t> common;
+        for (size_t v = begin; v < end; ++v) {
+            const uint32_t* rowV = out.data() + outStart[v];
+            size_t lengthV = outStart[v + 1] - outStart[v];
+            common.resize(lengthV);
+            uint64_t atV = 0;
+            for (size_t i = 0; i < lengthV; ++i) {
+                uint32_t u = rowV[i];
+                size_t found = intersect(rowV, lengthV, out.data() + outStart[u], outStart[u + 1] - outStart[u],
+                                         common.data());
+                if (found == 0) {
+                    continue;
+                }
+                atV += found;
+                __atomic_add_fetch(&count[u], found, __ATOMIC_RELAXED);
+                for (size_t k = 0; k < found; ++k) {
+                    __atomic_add_fetch(&count[common[k]], 1, __ATOMIC_RELAXED);
+                }
+            }
+            if (atV) {
+                __atomic_add_fetch(&count[v], atV, __ATOMIC_RELAXED);
+            }
+        }
+    }, 1024);
+
+    result.clustering.assign(n, 0);
+    double triples = 0, clusteringSum = 0;
+    size_t eligible = 0;
+    for (size_t v = 0; v < n; ++v) {
+        result.total += count[v];
+        double pairs = 0.5 * degree[v] * (degree[v] - 1.0);
+        if (degree[v] >= 2) {
+            result.clustering[v] = count[v] / pairs;
+            clusteringSum += result.clustering[v];
+            triples += pairs;
+            ++eligible;
+        }
+    }
+    result.total /= 3;
+    result.transitivity = triples > 0 ? 3.0 * result.total / triples : 0;
+    result.averageClustering = eligible ? clusteringSum / eligible : 0;
+    return result;
+}
+
+} // namespace centrality
+
+#endif // TRIANGLES_H
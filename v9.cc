@@ -1,179 +1,34 @@
 /*
-Compile using [g++ v4.cpp -o gui `pkg-config --cflags --libs gtkmm-3.0`]
+Compile using [g++ -O2 -pthread v9.cc -o gui `pkg-config --cflags --libs gtkmm-3.0`]
+Follow a FIFO or growing file of node/edge records with [./gui --stream feed.txt]
 */
 
 #include <gtkmm.h>
 #include <iostream>
 #include <unordered_map>
 #include <unordered_set>
-#include <fstream>
 #include <sstream>
-#include <memory>
 #include <vector>
 #include <algorithm>
+#include <mutex>
+#include <shared_mutex>
 
-using namespace std;
-
-class Node {
-public:
-    int id;
-    unordered_set<string> characteristics;
-
-    Node(int id) : id(id) {}
-};
-
-class SocialNetwork {
-public:
-    void addNode(int id, const unordered_set<string>& characteristics) {
-        nodes.emplace(id, make_shared<Node>(id));
-        nodes[id]->characteristics = characteristics;
-        for (const auto& characteristic : characteristics) {
-            availableCharacteristics.insert(characteristic);
-        }
-    }
-
-    void addEdge(int id1, int id2) {
-        adjList[id1].insert(id2);
-        adjList[id2].insert(id1);
-    }
-
-    vector<pair<int, string>> postMessage(const string& keyword) {
-        vector<pair<int, string>> result;
-        unordered_set<int> reachedNodes;
-        unordered_set<int> notReachedNodes;
-
-        for (const auto& pair : nodes) {
-            const Node& node = *(pair.second);
-            if (node.characteristics.count(keyword)) {
-                reachedNodes.insert(node.id);
-            } else {
-                notReachedNodes.insert(node.id);
-            }
-        }
+#include "social_network.h"
+#include "stream_ingest.h"
 
-        for (int nodeId : reachedNodes) {
-            result.push_back({nodeId, "Received"});
-        }
-
-        for (int nodeId : notReachedNodes) {
-            result.push_back({nodeId, "Not Received"});
-        }
-
-        return result;
-    }
-
-    vector<int> targetAds(const unordered_set<string>& targetCharacteristics) {
-        vector<int> result;
-        for (const auto& pair : nodes) {
-            const Node& node = *(pair.second);
-            bool matchesTarget = true;
-            for (const string& target : targetCharacteristics) {
-                if (node.characteristics.find(target) == node.characteristics.end()) {
-                    matchesTarget = false;
-                    break;
-                }
-            }
-            if (matchesTarget) {
-                result.push_back(node.id);
-            }
-        }
-        return result;
-    }
-
-    pair<vector<pair<int, vector<int>>>, pair<int, int>> calculateDominanceAndInfluence(const unordered_set<string>& targetCharacteristics = {}) {
-        vector<pair<int, vector<int>>> dominanceLevels;
-        unordered_map<int, int> influenceCount;
-
-        for (const auto& pair : adjList) {
-            int node = pair.first;
-            if (!targetCharacteristics.empty()) {
-                const Node& nodeObj = *(nodes[node]);
-                bool matchesTarget = true;
-                for (const string& target : targetCharacteristics) {
-                    if (nodeObj.characteristics.find(target) == nodeObj.characteristics.end()) {
-                        matchesTarget = false;
-                        break;
-                    }
-                }
-                if (!matchesTarget) {
-                    continue;
-                }
-            }
-
-            vector<int> connections(pair.second.begin(), pair.second.end());
-            dominanceLevels.push_back({node, connections});
-            influenceCount[node] = connections.size();
-        }
-
-        sort(dominanceLevels.begin(), dominanceLevels.end(),
-             [](const pair<int, vector<int>>& a, const pair<int, vector<int>>& b) {
-                 return a.second.size() > b.second.size();
-             });
-
-        int topDominator = dominanceLevels.empty() ? -1 : dominanceLevels.front().first;
-        int topInfluencer = -1;
-        if (!influenceCount.empty()) {
-            topInfluencer = max_element(influenceCount.begin(), influenceCount.end(),
-                                        [](const pair<int, int>& a, const pair<int, int>& b) {
-                                            return a.second < b.second;
-                                        })->first;
-        }
-
-        return {dominanceLevels, {topDominator, topInfluencer}};
-    }
-
-    void readFromFile(const string& filename) {
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cerr << "Error opening file: " << filename << endl;
-            return;
-        }
-
-        string line;
-        bool readingNodes = true;
-        int lineNumber = 0;
-        while (getline(file, line)) {
-            lineNumber++;
-            if (line == "edges") {
-                readingNodes = false;
-                continue;
-            }
-
-            istringstream iss(line);
-            if (readingNodes) {
-                int id;
-                if (!(iss >> id)) {
-                    cerr << "Error reading node ID at line " << lineNumber << endl;
-                    continue;
-                }
-                unordered_set<string> characteristics;
-                string characteristic;
-                while (iss >> characteristic) {
-                    characteristics.insert(characteristic);
-                }
-                addNode(id, characteristics);
-            } else {
-                int id1, id2;
-                if (!(iss >> id1 >> id2)) {
-                    cerr << "Error reading edge at line " << lineNumber << endl;
-                    continue;
-                }
-                addEdge(id1, id2);
-            }
-        }
-    }
-
-    const unordered_set<string>& getAvailableCharacteristics() const {
-        return availableCharacteristics;
-    }
-
-private:
-    unordered_map<int, shared_ptr<Node>> nodes;
-    unordered_map<int, unordered_set<int>> adjList;
-    unordered_set<string> availableCharacteristics;
-};
+using namespace std;
 
 SocialNetwork network;
+shared_mutex networkLock; // held shared by the handlers, exclusive by stream batches
+
+// Rows listed by the dominance button; the ranking itself covers every node.
+const size_t kDominanceRows = 1000;
+// Islands listed by the islands button, largest first, with their top characteristics.
+const size_t kIslandRows = 1000;
+const size_t kIslandCharacteristics = 5;
+// Community rows are appended this many per idle callback, so a large
+// result fills the list without freezing the window.
+const size_t kStreamedRowsPerIdle = 200;
 
 class MainWindow : public Gtk::Window {
 public:
@@ -207,15 +62,25 @@ public:
         grid.attach(target_ads_button, 2, 1, 1, 1);
 
         // Populate combobox with available characteristics
-        for (const auto& characteristic : network.getAvailableCharacteristics()) {
-            target_ads_combobox.append(characteristic);
+        shared_lock<shared_mutex> reader(networkLock);
+        const auto& characteristics = network.getAvailableCharacteristics();
+        for (uint32_t id = 0; id < characteristics.size(); ++id) {
+            target_ads_combobox.append(characteristics.name(id));
         }
 
         // Dominance section
         dominance_button.set_label("Calculate Dominance and Influence");
         dominance_button.set_name("dominance");
         dominance_button.signal_clicked().connect(sigc::mem_fun(*this, &MainWindow::on_dominance_clicked));
-        grid.attach(dominance_button, 0, 3, 3, 1);
+        grid.attach(dominance_button, 0, 3, 2, 1);
+
+        dominance_mode_combobox.append("degree", "Rank by degree");
+        dominance_mode_combobox.append("pagerank", "Rank by PageRank");
+        dominance_mode_combobox.append("betweenness", "Rank by betweenness");
+        dominance_mode_combobox.append("coreness", "Rank by k-core");
+        dominance_mode_combobox.append("clustering", "Rank by clustering");
+        dominance_mode_combobox.set_active_id("degree");
+        grid.attach(dominance_mode_combobox, 2, 3, 1, 1);
 
         // Quit button
         quit_button.set_label("Quit");
@@ -250,6 +115,32 @@ public:
         top_influencer_value.set_name("top_influencer_value");
         grid.attach(top_influencer_value, 1, 6, 2, 1);
 
+        // Propagation: with seed IDs, Post Message spreads through friendships
+        seed_label.set_text("Seed node IDs and hop limit (-1 = none):");
+        grid.attach(seed_label, 0, 7, 1, 1);
+        grid.attach(seed_entry, 1, 7, 1, 1);
+        hop_spin.set_range(-1, 1000);
+        hop_spin.set_increments(1, 5);
+        hop_spin.set_value(-1);
+        grid.attach(hop_spin, 2, 7, 1, 1);
+
+        // Audience islands: connected components with their characteristics
+        islands_button.set_label("Show Audience Islands");
+        islands_button.set_name("islands");
+        islands_button.signal_clicked().connect(sigc::mem_fun(*this, &MainWindow::on_islands_clicked));
+        grid.attach(islands_button, 0, 8, 3, 1);
+
+        // Interest communities: Louvain with a resolution knob
+        communities_button.set_label("Detect Communities");
+        communities_button.set_name("communities");
+        communities_button.signal_clicked().connect(sigc::mem_fun(*this, &MainWindow::on_communities_clicked));
+        grid.attach(communities_button, 0, 9, 2, 1);
+        resolution_spin.set_range(0.1, 10);
+        resolution_spin.set_increments(0.1, 1);
+        resolution_spin.set_digits(1);
+        resolution_spin.set_value(1);
+        grid.attach(resolution_spin, 2, 9, 1, 1);
+
         apply_css("stll.css");
 
         show_all_children();
@@ -269,9 +160,18 @@ protected:
 
     void on_post_message_clicked() {
         string keyword = post_message_entry.get_text();
-        auto result = network.postMessage(keyword);
+        istringstream iss(seed_entry.get_text());
+        vector<int> seeds;
+        int seed;
+        while (iss >> seed) {
+            seeds.push_back(seed);
+        }
 
-        list_store->clear();
+        shared_lock<shared_mutex> reader(networkLock);
+        auto result = seeds.empty() ? network.postMessage(keyword)
+                                    : network.postMessage(keyword, seeds, hop_spin.get_value_as_int());
+
+        clear_results();
         for (const auto& entry : result) {
             Gtk::TreeModel::Row row = *(list_store->append());
             row[columns.col_id] = entry.first;
@@ -279,24 +179,25 @@ protected:
         }
     }
 
+    // The entry is a targeting expression (plain space-separated names are
+    // an AND); with the entry empty, the combo box picks one characteristic.
     void on_target_ads_clicked() {
-        string characteristicsStr = target_ads_entry.get_text();
-        string selectedCharacteristic = target_ads_combobox.get_active_text();
-
-        unordered_set<string> targetCharacteristics;
-        if (!characteristicsStr.empty()) {
-            istringstream iss(characteristicsStr);
-            string characteristic;
-            while (iss >> characteristic) {
-                targetCharacteristics.insert(characteristic);
-            }
-        } else if (!selectedCharacteristic.empty()) {
-            targetCharacteristics.insert(selectedCharacteristic);
+        string expression = target_ads_entry.get_text();
+        if (expression.empty()) {
+            expression = target_ads_combobox.get_active_text();
         }
 
-        auto result = network.targetAds(targetCharacteristics);
+        shared_lock<shared_mutex> reader(networkLock);
+        string error;
+        auto result = network.targetAds(expression, error);
 
-        list_store->clear();
+        clear_results();
+        if (!error.empty()) {
+            Gtk::TreeModel::Row row = *(list_store->append());
+            row[columns.col_id] = 0;
+            row[columns.col_status] = "Invalid expression: " + error;
+            return;
+        }
         for (int nodeId : result) {
             Gtk::TreeModel::Row row = *(list_store->append());
             row[columns.col_id] = nodeId;
@@ -319,21 +220,100 @@ protected:
             targetCharacteristics.insert(selectedCharacteristic);
         }
 
-        auto result = network.calculateDominanceAndInfluence(targetCharacteristics);
+        shared_lock<shared_mutex> reader(networkLock);
+        string modeId = dominance_mode_combobox.get_active_id();
+        DominanceMode mode = modeId == "pagerank"      ? DominanceMode::PageRank
+                             : modeId == "betweenness" ? DominanceMode::Betweenness
+                             : modeId == "coreness"    ? DominanceMode::Coreness
+                             : modeId == "clustering"  ? DominanceMode::Clustering
+                                                       : DominanceMode::Degree;
+        auto rows = network.topDominance(kDominanceRows, targetCharacteristics, mode);
+
+        // Neighbor text only for the rows shown
+        clear_results();
+        for (const auto& entry : rows) {
+            Gtk::TreeModel::Row row = *(list_store->append());
+            row[columns.col_id] = entry.id;
+            stringstream ss;
+            for (uint32_t neighbor : network.neighbors(entry.index)) {
+                ss << network.node(neighbor).id() << " ";
+            }
+            row[columns.col_status] = ss.str();
+        }
+
+        top_dominator_value.set_text(to_string(rows.empty() ? -1 : rows.front().id));
+        top_influencer_value.set_text(to_string(rows.empty() ? -1 : network.topInfluencerFor(targetCharacteristics)));
+    }
 
-        list_store->clear();
-        for (const auto& entry : result.first) {
+    // Island number in the ID column, then its size and most common
+    // characteristics.
+    void on_islands_clicked() {
+        shared_lock<shared_mutex> reader(networkLock);
+        components::Result islands = network.connectedComponents();
+        vector<components::Histogram> histograms = network.islandCharacteristics(islands);
+        const auto& characteristics = network.getAvailableCharacteristics();
+
+        clear_results();
+        for (size_t c = 0; c < min(kIslandRows, islands.sizes.size()); ++c) {
             Gtk::TreeModel::Row row = *(list_store->append());
-            row[columns.col_id] = entry.first;
+            row[columns.col_id] = static_cast<int>(c + 1);
             stringstream ss;
-            for (int conn : entry.second) {
-                ss << conn << " ";
+            ss << islands.sizes[c] << " nodes";
+            for (size_t i = 0; i < min(kIslandCharacteristics, histograms[c].size()); ++i) {
+                ss << (i ? ", " : " - ") << characteristics.name(histograms[c][i].first) << " " << histograms[c][i].second;
             }
             row[columns.col_status] = ss.str();
         }
+    }
+
+    // Detection runs under the read lock; the rows, which can number in the
+    // hundreds of thousands, are then streamed into the list from idle time.
+    void on_communities_clicked() {
+        community::Options options;
+        options.resolution = resolution_spin.get_value();
+        vector<pair<int, string>> rows;
+        {
+            shared_lock<shared_mutex> reader(networkLock);
+            community::Result found = network.communities(options);
+            vector<components::Histogram> histograms = network.communityCharacteristics(found);
+            const auto& characteristics = network.getAvailableCharacteristics();
+            for (size_t c = 0; c < found.sizes.size(); ++c) {
+                stringstream ss;
+                ss << found.sizes[c] << " nodes";
+                for (size_t i = 0; i < min(kIslandCharacteristics, histograms[c].size()); ++i) {
+                    ss << (i ? ", " : " - ") << characteristics.name(histograms[c][i].first) << " "
+                       << histograms[c][i].second;
+                }
+                rows.emplace_back(static_cast<int>(c + 1), ss.str());
+            }
+        }
+
+        clear_results();
+        streamed_rows = move(rows);
+        if (!streaming_rows) {
+            streaming_rows = true;
+            Glib::signal_idle().connect(sigc::mem_fun(*this, &MainWindow::on_stream_rows));
+        }
+    }
 
-        top_dominator_value.set_text(to_string(result.second.first));
-        top_influencer_value.set_text(to_string(result.second.second));
+    // Appends the next batch of streamed rows; returns false (disconnecting
+    // the idle handler) once they are all shown.
+    bool on_stream_rows() {
+        size_t end = min(streamed_next + kStreamedRowsPerIdle, streamed_rows.size());
+        for (; streamed_next < end; ++streamed_next) {
+            Gtk::TreeModel::Row row = *(list_store->append());
+            row[columns.col_id] = streamed_rows[streamed_next].first;
+            row[columns.col_status] = streamed_rows[streamed_next].second;
+        }
+        streaming_rows = streamed_next < streamed_rows.size();
+        return streaming_rows;
+    }
+
+    // Empties the result list, dropping any rows still waiting to stream in.
+    void clear_results() {
+        list_store->clear();
+        streamed_rows.clear();
+        streamed_next = 0;
     }
 
     void on_quit_clicked() {
@@ -360,6 +340,7 @@ private:
     Gtk::Button target_ads_button;
 
     Gtk::Button dominance_button;
+    Gtk::ComboBoxText dominance_mode_combobox;
     Gtk::Button quit_button;
 
     Gtk::Label top_dominator_label;
@@ -367,6 +348,17 @@ private:
     Gtk::Label top_influencer_label;
     Gtk::Label top_influencer_value;
 
+    Gtk::Label seed_label;
+    Gtk::Entry seed_entry;
+    Gtk::SpinButton hop_spin;
+
+    Gtk::Button islands_button;
+    Gtk::Button communities_button;
+    Gtk::SpinButton resolution_spin;
+    vector<pair<int, string>> streamed_rows;
+    size_t streamed_next = 0;
+    bool streaming_rows = false;
+
     Gtk::ScrolledWindow scrolled_window;
     Gtk::TreeView tree_view;
     Glib::RefPtr<Gtk::ListStore> list_store;
@@ -374,10 +366,27 @@ private:
 };
 
 int main(int argc, char* argv[]) {
+    // Take --stream <source> out before GTK sees the arguments
+    string streamSource;
+    if (argc > 2 && string(argv[1]) == "--stream") {
+        streamSource = argv[2];
+        for (int i = 3; i <= argc; ++i) {
+            argv[i - 2] = argv[i];
+        }
+        argc -= 2;
+    }
+
     auto app = Gtk::Application::create(argc, argv, "org.gtkmm.example");
 
-    // Read the social network data from the file
-    network.readFromFile("nodes.txt");
+    // Read the social network data, preferring an up-to-date nodes.snap
+    network.load("nodes.txt");
+
+    StreamIngest::Options options;
+    options.reportProgress = false;
+    StreamIngest stream(network, networkLock, options);
+    if (!streamSource.empty() && !stream.start(streamSource)) {
+        return 1;
+    }
 
     MainWindow window;
 